@@ -7,38 +7,109 @@
 #include <map>
 #include <csignal>
 #include <cstdlib>
+#include <string>
+#include <vector>
+#include <unistd.h>
 
 using namespace std;
 using gaussdb::buffer::LRUBufferPool;
+using gaussdb::buffer::LRUBufferPoolOptions;
 using gaussdb::buffer::BufferPool;
 using gaussdb::server::Server;
+using gaussdb::server::ServerOptions;
 
-static bool g_program_shutdown = false;
-static int server_socket = -1;
-
-// 信号处理：Ctrl+C 退出
-void signal_handler(int signum)
+// 信号处理：Ctrl+C 退出（只调用异步信号安全的 request_shutdown）
+void signal_handler(int /*signum*/)
 {
-  cerr << "[INFO] Got signal SIGINT.\n";
-  g_program_shutdown = true;
-  if (server_socket > 0)
-  {
-    shutdown(server_socket, SHUT_RDWR);
-  }
+  static const char msg[] = "[INFO] Got signal SIGINT.\n";
+  ssize_t r = write(STDERR_FILENO, msg, sizeof(msg) - 1);
+  (void)r;
+  Server::request_shutdown();
 }
 
 /**
  * 服务端主程序入口
  * @param argc 参数列表
- * @param argv 程序名 数据文件路径 socket文件路径 各页大小对应的页数
+ * @param argv 程序名 数据文件路径 socket文件路径 各页大小对应的页数，可穿插 --key=value 形式的可选参数
  * @return
  */
 int main(int argc, char *argv[])
 {
+  // 拆分可选参数（--key=value）与位置参数
+  LRUBufferPoolOptions options;
+  ServerOptions server_options;
+  vector<char *> args;
+  for (int i = 0; i < argc; i++)
+  {
+    string arg = argv[i];
+    if (arg.rfind("--shards=", 0) == 0)
+    {
+      options.shard_count = static_cast<size_t>(stoul(arg.substr(9)));
+    }
+    else if (arg.rfind("--budget-mb=", 0) == 0)
+    {
+      options.memory_budget = static_cast<size_t>(stoul(arg.substr(12))) * 1024 * 1024;
+    }
+    else if (arg == "--shared-budget")
+    {
+      options.shared_class_budget = true;
+    }
+    else if (arg.rfind("--policy=", 0) == 0)
+    {
+      options.replacement_policy = arg.substr(9);
+    }
+    else if (arg.rfind("--cleaners=", 0) == 0)
+    {
+      options.cleaner_threads = static_cast<size_t>(stoul(arg.substr(11)));
+    }
+    else if (arg.rfind("--dirty-ratio=", 0) == 0)
+    {
+      options.dirty_ratio_target = stod(arg.substr(14));
+    }
+    else if (arg.rfind("--max-write-kb=", 0) == 0)
+    {
+      options.max_write_bytes = static_cast<size_t>(stoul(arg.substr(15))) * 1024;
+    }
+    else if (arg.rfind("--readahead-threads=", 0) == 0)
+    {
+      options.readahead_threads = static_cast<size_t>(stoul(arg.substr(20)));
+    }
+    else if (arg.rfind("--reactors=", 0) == 0)
+    {
+      server_options.reactor_threads = static_cast<size_t>(stoul(arg.substr(11)));
+    }
+    else if (arg.rfind("--workers=", 0) == 0)
+    {
+      server_options.worker_threads = static_cast<size_t>(stoul(arg.substr(10)));
+    }
+    else if (arg == "--direct-io")
+    {
+      options.direct_io = true;
+    }
+    else if (arg.rfind("--io=", 0) == 0)
+    {
+      options.io_backend = arg.substr(5);
+    }
+    else
+    {
+      args.push_back(argv[i]);
+    }
+  }
+  argc = static_cast<int>(args.size());
+  argv = args.data();
+
   if (argc < 5)
   {
     cerr << "usage: " << argv[0]
-         << " /path/to/datafile /tmp/sockfile.sock <count_for_8k> <count_for_16k> [<count_for_32k> <count_for_2m>]\n";
+         << " /path/to/datafile /tmp/sockfile.sock <count_for_8k> <count_for_16k> [<count_for_32k> <count_for_2m>]"
+         << " [--shards=N] [--budget-mb=N] [--shared-budget] [--policy=NAME]"
+         << " [--cleaners=N] [--dirty-ratio=F] [--max-write-kb=N]"
+         << " [--readahead-threads=N] [--io=auto|sync|io_uring] [--direct-io]"
+         << " [--reactors=N (0 = thread per connection)] [--workers=N]\n";
+    cerr << "policies:";
+    for (auto &name : gaussdb::buffer::ReplacementPolicyNames())
+      cerr << " " << name;
+    cerr << "\n";
     return -1;
   }
 
@@ -61,7 +132,7 @@ int main(int argc, char *argv[])
   BufferPool *bp = nullptr;
   try
   {
-    bp = new LRUBufferPool(datafile, page_no_info);
+    bp = new LRUBufferPool(datafile, page_no_info, options);
     cerr << "[INFO] LRUBufferPool created successfully.\n";
   }
   catch (const std::exception &e)
@@ -71,7 +142,7 @@ int main(int argc, char *argv[])
   }
 
   // 启动 Server
-  Server server(bp, socket_file.c_str());
+  Server server(bp, socket_file.c_str(), server_options);
   if (server.create_socket() != 0)
   {
     delete bp;
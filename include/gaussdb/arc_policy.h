@@ -0,0 +1,53 @@
+#pragma once
+#include "gaussdb/replacement_policy.h"
+#include "gaussdb/page_list.h"
+#include "gaussdb/ghost_list.h"
+
+namespace gaussdb::buffer
+{
+
+    /**
+     * @brief ARCPolicy：自适应替换缓存（Megiddo & Modha, ARC）
+     *
+     * 特性：
+     *  - T1：只访问过一次的驻留页（近期性），T2：访问过至少两次的驻留页（频率）；
+     *  - B1 / B2：分别记录最近从 T1 / T2 驱逐的页号（幽灵列表，不占帧内存）；
+     *  - 缺页命中 B1 说明 T1 偏小，增大目标值 p；命中 B2 说明 T2 偏小，减小 p；
+     *  - 驱逐时 |T1| 超过 p 则从 T1 冷端驱逐，否则从 T2 冷端驱逐。
+     *
+     * p 随负载在近期性与频率之间自动调节，无需手工调参，当前值通过 CollectStats 汇报。
+     */
+    class ARCPolicy : public ReplacementPolicy
+    {
+    public:
+        explicit ARCPolicy(size_t capacity);
+
+        const char *name() const noexcept override { return "arc"; }
+        void RecordAccess(Page *page) override;
+        void Insert(Page *page) override;
+        Page *PickVictim(pageno incoming) override;
+        void Remove(Page *page) override;
+        void ColdPages(size_t max, std::vector<Page *> &out) const override;
+        void CollectStats(std::map<std::string, double> &stats) const override;
+
+    private:
+        /// Page::ListHook::queue 的取值
+        enum Queue : uint8_t
+        {
+            kT1 = 1,
+            kT2 = 2,
+        };
+
+        /// 若 incoming 命中幽灵列表，按 ARC 规则调整后的目标值（不修改 target_）
+        double AdaptedTarget(pageno incoming) const;
+        void TrimGhosts();
+
+        double capacity_;
+        double target_{0}; ///< T1 的目标大小 p，取值 [0, capacity]
+        PageList t1_;
+        PageList t2_;
+        GhostList b1_;
+        GhostList b2_;
+    };
+
+} // namespace gaussdb::buffer
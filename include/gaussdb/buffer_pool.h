@@ -1,13 +1,22 @@
 #pragma once
 #include <cstddef>
+#include <functional>
 #include <map>
 #include <string>
+#include <vector>
 
 namespace gaussdb::buffer
 {
 
     using pageno = unsigned int;
 
+    /** 批量请求中的一项 */
+    struct PageRequest
+    {
+        pageno no;
+        unsigned int page_size;
+    };
+
     /** Buffer Pool申明，请按规则实现以下接口*/
     class BufferPool
     {
@@ -23,12 +32,81 @@ namespace gaussdb::buffer
             : file_name_(std::move(file_name)), page_no_info_(page_no_info) {}
             /** 初始化你的buffer pool，初始化耗时不得超过3分钟 */
 
+        /** 页号所属的页大小（页号按页大小从小到大连续编号），页号越界返回 0 */
+        size_t page_size_of(pageno no) const
+        {
+            size_t n = no;
+            for (auto &[psize, pcount] : page_no_info_)
+            {
+                if (n < pcount)
+                    return psize;
+                n -= pcount;
+            }
+            return 0;
+        }
+
         // 读取页面到 buf（子类实现）
         virtual void read_page(pageno no, unsigned int page_size, void *buf, int t_idx) = 0;
 
         // 将 buf 写回页面（子类实现）
         virtual void write_page(pageno no, unsigned int page_size, void *buf, int t_idx) = 0;
 
+        /**
+         * 零拷贝读取：以页面内容调用 fn(data, len)，成功返回 true。
+         * 回调期间页面保持不变（不会被驱逐或修改），fn 可直接把 data 写到 socket，但只能非阻塞发送，发不出的部分须复制走。
+         * 默认实现经 read_page 复制到临时缓冲区；子类可改为直接交出帧内存
+         */
+        virtual bool with_page_read(pageno no, unsigned int page_size, int t_idx,
+                                    const std::function<void(const void *data, size_t len)> &fn)
+        {
+            std::vector<unsigned char> buf(page_size);
+            read_page(no, page_size, buf.data(), t_idx);
+            fn(buf.data(), buf.size());
+            return true;
+        }
+
+        /**
+         * 批量零拷贝读取：按请求顺序对每一页调用一次 fn(i, data, len)，i 为 pages 中的下标；
+         * 页面无法获取时 data 为 nullptr、len 为 0。每次回调期间的保证同 with_page_read。
+         * fn 返回 false 时停止，其余页不再回调，返回前放掉本批的 pin（例如 socket 已写满，调用方稍后从下一页继续）。
+         * 默认实现逐页调用 with_page_read；子类可先把缺页一次性并行读入
+         */
+        virtual void with_pages_read(const PageRequest *pages, size_t count, int t_idx,
+                                     const std::function<bool(size_t i, const void *data, size_t len)> &fn)
+        {
+            for (size_t i = 0; i < count; ++i)
+            {
+                bool more = true;
+                if (!with_page_read(pages[i].no, pages[i].page_size, t_idx,
+                                    [&](const void *data, size_t len)
+                                    { more = fn(i, data, len); }))
+                    more = fn(i, nullptr, 0);
+                if (!more)
+                    return;
+            }
+        }
+
+        /**
+         * 整页写入：以页面内存调用 fn(data, len)，由 fn 用调用方已完整收到的数据覆盖整页（例如从请求缓冲区复制），
+         * 成功返回 true；页面无法获取时不调用 fn，返回 false。
+         * 回调期间其他请求读写同一页需等待，fn 只做复制，不得等待客户端输入。
+         * 默认实现让 fn 填充临时缓冲区，再经 write_page 写入
+         */
+        virtual bool with_page_write(pageno no, unsigned int page_size, int t_idx,
+                                     const std::function<void(void *data, size_t len)> &fn)
+        {
+            std::vector<unsigned char> buf(page_size);
+            fn(buf.data(), buf.size());
+            write_page(no, page_size, buf.data(), t_idx);
+            return true;
+        }
+
+        /**
+         * 预取提示：调用方稍后会访问这些页。缓冲池可在后台异步读入其中不在缓冲池的页，
+         * 读入后不 pin，照常参与驱逐；调用立即返回，不保证执行。默认忽略提示
+         */
+        virtual void prefetch_pages(const pageno * /*pages*/, size_t /*count*/, int /*t_idx*/) {}
+
         // 展示命中率 / 状态（可空实现）
         virtual void show_hit_rate() = 0;
 
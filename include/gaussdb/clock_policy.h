@@ -0,0 +1,37 @@
+#pragma once
+#include "gaussdb/replacement_policy.h"
+#include "gaussdb/page_list.h"
+
+namespace gaussdb::buffer
+{
+
+    /**
+     * @brief ClockPolicy：CLOCK（二次机会）替换
+     *
+     * 特性：
+     *  - 帧排成一个环，命中只以 relaxed 原子写置位 Page 的访问位，可在分片共享锁下并发进行；
+     *  - 只有驱逐线程（持有分片独占锁）推进时钟指针：访问位为 1 则清零跳过，为 0 且未被 pin 则选中；
+     *  - 新页插入到指针之前，即一整圈之后才会被检查。
+     */
+    class ClockPolicy : public ReplacementPolicy
+    {
+    public:
+        explicit ClockPolicy(size_t capacity);
+
+        const char *name() const noexcept override { return "clock"; }
+        bool concurrent_access() const noexcept override { return true; }
+        void RecordAccess(Page *page) override;
+        void Insert(Page *page) override;
+        Page *PickVictim(pageno incoming) override;
+        void Remove(Page *page) override;
+        void ColdPages(size_t max, std::vector<Page *> &out) const override;
+
+    private:
+        /// 指针的下一个位置（环形）
+        Page *Next(Page *page) const noexcept;
+
+        PageList ring_;
+        Page *hand_{nullptr};
+    };
+
+} // namespace gaussdb::buffer
@@ -0,0 +1,48 @@
+#pragma once
+#include "gaussdb/page.h"
+
+#include <cstddef>
+
+namespace gaussdb::buffer
+{
+
+    /**
+     * @brief FrameArena：一种页大小的帧缓冲区，启动时一次性映射
+     *
+     * 特性：
+     *  - 所有帧来自同一段连续的匿名映射，按 frame_size 切分，天然按系统页对齐；
+     *  - 匿名映射由内核清零，帧无需再 memset，缺页读盘直接覆盖；
+     *  - prefault 时在启动阶段预先触发缺页，避免在请求路径上产生大量缺页中断；
+     *  - 不 prefault 时只保留地址空间（MAP_NORESERVE），物理内存在首次访问时提交，可用 Release() 归还；
+     *  - 析构时整体 munmap，帧描述符（Page）只引用而不拥有这段内存。
+     */
+    class FrameArena
+    {
+    public:
+        /**
+         * @brief 映射 frame_size * frame_count 字节
+         * @throw std::runtime_error 映射失败
+         */
+        FrameArena(size_t frame_size, size_t frame_count, bool prefault);
+        ~FrameArena();
+
+        FrameArena(const FrameArena &) = delete;
+        FrameArena &operator=(const FrameArena &) = delete;
+
+        byte *frame(size_t index) const noexcept { return base_ + index * frame_size_; }
+
+        /// 归还帧的物理内存（内容丢弃，下次访问按需重新提交）
+        void Release(byte *frame) noexcept;
+        size_t frame_size() const noexcept { return frame_size_; }
+        size_t frame_count() const noexcept { return frame_count_; }
+        size_t bytes() const noexcept { return frame_size_ * frame_count_; }
+
+    private:
+        void Prefault();
+
+        byte *base_{nullptr};
+        size_t frame_size_;
+        size_t frame_count_;
+    };
+
+} // namespace gaussdb::buffer
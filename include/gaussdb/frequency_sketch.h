@@ -0,0 +1,40 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace gaussdb::buffer
+{
+
+    /**
+     * @brief FrequencySketch：4 位计数器的 count-min 频率草图（TinyLFU 使用）
+     *
+     * 特性：
+     *  - 4 行 × width 个 4 位计数器，每 16 个计数器打包进一个 uint64_t，内存约为 2 * width 字节；
+     *  - estimate() 取 4 行中的最小值，计数上限 15；
+     *  - 周期性老化：累计增加 10 * width 次后所有计数器减半，使频率反映近期热度。
+     *
+     * 非线程安全，由调用方（分片锁）保护。
+     */
+    class FrequencySketch
+    {
+    public:
+        /// @param expected_items 预计同时跟踪的条目数（通常为帧数），决定每行宽度
+        explicit FrequencySketch(size_t expected_items);
+
+        void increment(uint64_t key) noexcept;
+        unsigned estimate(uint64_t key) const noexcept;
+
+    private:
+        static constexpr int kDepth = 4;
+
+        size_t Index(uint64_t key, int row) const noexcept;
+        void Age() noexcept;
+
+        size_t width_;       ///< 每行计数器个数（2 的幂）
+        size_t sample_size_; ///< 触发老化的累计增加次数
+        size_t additions_{0};
+        std::vector<uint64_t> table_; ///< kDepth 行连续存放
+    };
+
+} // namespace gaussdb::buffer
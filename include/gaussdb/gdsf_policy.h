@@ -0,0 +1,47 @@
+#pragma once
+#include "gaussdb/replacement_policy.h"
+
+#include <set>
+#include <utility>
+
+namespace gaussdb::buffer
+{
+
+    /**
+     * @brief GDSFPolicy：GreedyDual-Size-Frequency，按"访问频率 × 重读代价 / 占用内存"排序
+     *
+     * 每个驻留页的优先级 H = L + frequency * cost / size：
+     *  - frequency：驻留期间的访问次数；
+     *  - cost：重新读入该页的估计代价（固定寻址开销 + 与页大小成正比的传输开销）；
+     *  - size：页占用的内存，以 8K 为单位；
+     *  - L：膨胀值，每次驱逐后更新为被驱逐页的 H，使长期未访问的页优先级相对下降（老化）。
+     *
+     * 驱逐 H 最小且未被 pin 的页。同样的访问频率下，大页的 cost / size 更低，
+     * 因此在各页大小共享内存预算时，一个冷的 2M 页会先于几百个温的 8K 页被回收。
+     * 优先级有序集合的插入、调整、删除均为 O(log n)。
+     */
+    class GDSFPolicy : public ReplacementPolicy
+    {
+    public:
+        explicit GDSFPolicy(size_t capacity);
+
+        const char *name() const noexcept override { return "gdsf"; }
+        void RecordAccess(Page *page) override;
+        void Insert(Page *page) override;
+        Page *PickVictim(pageno incoming) override;
+        void Remove(Page *page) override;
+        void ColdPages(size_t max, std::vector<Page *> &out) const override;
+        void CollectStats(std::map<std::string, double> &stats) const override;
+
+        /// 重新读入一页的估计代价（以读一个 8K 页为 1）
+        static double ReloadCost(size_t page_size) noexcept;
+
+    private:
+        double Priority(const Page *page, uint32_t frequency) const noexcept;
+        void Reposition(Page *page, double priority);
+
+        double inflation_{0}; ///< L
+        std::set<std::pair<double, Page *>> queue_; ///< 按 H 升序
+    };
+
+} // namespace gaussdb::buffer
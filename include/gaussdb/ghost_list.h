@@ -0,0 +1,42 @@
+#pragma once
+#include "gaussdb/buffer_pool.h"
+
+#include <cstddef>
+#include <list>
+#include <unordered_map>
+
+namespace gaussdb::buffer
+{
+
+    /**
+     * @brief GhostList：只记录页号的历史队列（不占帧内存）
+     *
+     * 供 2Q / ARC 等策略记住最近被驱逐的页号：再次缺页时若仍在历史中，
+     * 说明该页被重复使用，可直接进入长期队列。查找、插入、删除均为 O(1)。
+     * front 为最近加入端，back 为最早加入端。
+     */
+    class GhostList
+    {
+    public:
+        explicit GhostList(size_t capacity = 0) : capacity_(capacity) {}
+
+        bool contains(pageno no) const { return index_.count(no) != 0; }
+        size_t size() const noexcept { return order_.size(); }
+        bool empty() const noexcept { return order_.empty(); }
+
+        /// 加入最近端；超出容量时丢弃最早的记录（容量为 0 表示不限，由调用方裁剪）
+        void push_front(pageno no);
+        /// 删除记录，不存在时返回 false
+        bool erase(pageno no);
+        /// 丢弃最早的记录
+        void pop_back();
+
+        void set_capacity(size_t capacity) noexcept { capacity_ = capacity; }
+
+    private:
+        size_t capacity_;
+        std::list<pageno> order_;
+        std::unordered_map<pageno, std::list<pageno>::iterator> index_;
+    };
+
+} // namespace gaussdb::buffer
@@ -0,0 +1,66 @@
+#pragma once
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+#include <sys/types.h>
+#include <sys/uio.h>
+
+namespace gaussdb::buffer
+{
+
+    /**
+     * @brief IoRequest：一次文件读写，数据可分散在多段内存（iovec）中
+     *
+     * 读请求读到文件末尾时，剩余部分补零，仍视为成功。
+     */
+    struct IoRequest
+    {
+        bool write{false};
+        int fd{-1};
+        off_t offset{0};
+        std::vector<iovec> iov;
+        bool ok{false}; ///< 完成后由后端填写：全部字节读写成功
+    };
+
+    /**
+     * @brief IoBackend：缓冲池的磁盘 I/O 接口
+     *
+     * 约定：
+     *  - Submit 提交一批请求并阻塞到全部完成，同一批内的请求可并发执行；
+     *  - 多个线程可同时调用 Submit；
+     *  - iovec 指向的内存在 Submit 返回前须保持有效，实现可能修改 IoRequest::iov。
+     */
+    class IoBackend
+    {
+    public:
+        virtual ~IoBackend() = default;
+
+        /// 后端名称（与 MakeIoBackend 的参数一致）
+        virtual const char *name() const noexcept = 0;
+
+        /**
+         * @brief 注册固定缓冲区（例如帧内存），之后落在其中的单段请求可免去每次 I/O 的页面映射
+         * @return false 表示不支持或注册失败，请求仍可正常提交
+         */
+        virtual bool RegisterBuffers(const std::vector<iovec> & /*regions*/) { return false; }
+
+        /// 提交 count 个请求并等待全部完成，结果写入各请求的 ok
+        virtual void Submit(IoRequest *reqs, size_t count) = 0;
+
+        /// 提交单个请求并等待完成
+        bool Submit(IoRequest &req)
+        {
+            Submit(&req, 1);
+            return req.ok;
+        }
+    };
+
+    /**
+     * @brief 按名称创建 I/O 后端："sync"、"io_uring"，或 "auto"（io_uring 不可用时退回 sync）
+     * @throw std::invalid_argument 未知的名称
+     * @throw std::runtime_error 明确要求 io_uring 但内核不支持
+     */
+    std::unique_ptr<IoBackend> MakeIoBackend(const std::string &name);
+
+} // namespace gaussdb::buffer
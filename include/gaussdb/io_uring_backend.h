@@ -0,0 +1,88 @@
+#pragma once
+#include "gaussdb/io_backend.h"
+
+#include <condition_variable>
+#include <mutex>
+
+struct io_uring_sqe;
+struct io_uring_cqe;
+
+namespace gaussdb::buffer
+{
+
+    /**
+     * @brief IoUringBackend：基于 io_uring 的异步 I/O 后端（直接使用系统调用，不依赖 liburing）
+     *
+     * 特性：
+     *  - 一批请求一次性放入提交队列，一次 io_uring_enter 提交，由内核并发执行；
+     *  - 所有线程共享同一个 ring：同一时刻只有一个线程在内核中等待完成事件，
+     *    收割到的完成事件按 user_data 分发给各自的请求，再唤醒等待中的提交者；
+     *  - 注册固定缓冲区（帧内存）后，落在其中的单段请求使用 READ_FIXED/WRITE_FIXED，省去每次 I/O 的页面固定；
+     *  - 部分读写自动续提交，读到文件末尾时补零，语义与 SyncIoBackend 一致；
+     *  - 内核拒绝提交或无法等待完成事件时，受影响的请求以失败完成，不抛出异常。
+     */
+    class IoUringBackend : public IoBackend
+    {
+    public:
+        /**
+         * @brief 创建 entries 个提交槽位的 ring
+         * @throw std::runtime_error 内核不支持 io_uring（或缺少 IORING_FEAT_NODROP）
+         */
+        explicit IoUringBackend(unsigned entries = 256);
+        ~IoUringBackend() override;
+
+        IoUringBackend(const IoUringBackend &) = delete;
+        IoUringBackend &operator=(const IoUringBackend &) = delete;
+
+        const char *name() const noexcept override { return "io_uring"; }
+        bool RegisterBuffers(const std::vector<iovec> &regions) override;
+        void Submit(IoRequest *reqs, size_t count) override;
+
+    private:
+        struct Batch;
+        /// 一个请求的进度：已完成的 iovec 段与下一次提交的文件偏移
+        struct Pending
+        {
+            IoRequest *req{nullptr};
+            Batch *batch{nullptr};
+            size_t first{0};
+            off_t offset{0};
+        };
+
+        /// 以下均须持有 mutex_
+        void Queue(Pending *p);
+        /// 把已放入提交队列的 SQE 交给内核
+        void Flush();
+        /// 收回尚未交给内核的 SQE，以 res（-errno）完成对应请求
+        void FailUnsubmitted(int res);
+        /// 收割完成队列中的全部事件，返回收割的数量
+        size_t Reap();
+        void Complete(Pending *p, int res);
+        /// 请求的单段缓冲区落在已注册的区域内时返回其下标，否则 -1
+        int FixedIndex(const iovec &iov) const noexcept;
+
+        int ring_fd_{-1};
+        void *sq_ring_{nullptr};
+        void *cq_ring_{nullptr};
+        size_t sq_ring_bytes_{0};
+        size_t cq_ring_bytes_{0};
+        io_uring_sqe *sqes_{nullptr};
+        size_t sqes_bytes_{0};
+        unsigned *sq_head_{nullptr};
+        unsigned *sq_tail_{nullptr};
+        unsigned sq_mask_{0};
+        unsigned sq_entries_{0};
+        unsigned *cq_head_{nullptr};
+        unsigned *cq_tail_{nullptr};
+        unsigned cq_mask_{0};
+        io_uring_cqe *cqes_{nullptr};
+
+        std::mutex mutex_;                ///< 保护提交队列、完成队列与各请求进度
+        std::condition_variable done_cv_; ///< 收割到完成事件后通知等待中的提交者
+        unsigned unsubmitted_{0};         ///< 已放入提交队列、尚未交给内核的 SQE 数
+        bool reaping_{false};             ///< 已有线程在内核中等待完成事件
+        bool broken_{false};              ///< 等待完成事件时出现无法恢复的错误，之后的请求直接失败
+        std::vector<iovec> fixed_;        ///< 已注册的固定缓冲区
+    };
+
+} // namespace gaussdb::buffer
@@ -1,12 +1,22 @@
 #pragma once
 #include "gaussdb/page.h"
+#include "gaussdb/replacement_policy.h"
+#include "gaussdb/frame_arena.h"
+#include "gaussdb/io_backend.h"
 #include "gaussdb/buffer_pool.h"
 
 #include <unordered_map>
-#include <list>
 #include <mutex>
+#include <shared_mutex>
 #include <memory>
 #include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <thread>
+#include <cstdint>
+#include <vector>
+#include <string>
 #include <fcntl.h>
 #include <unistd.h>
 
@@ -14,45 +24,297 @@ namespace gaussdb::buffer
 {
 
     /**
-     * @brief LRUBufferPool：实现基于 LRU 的缓冲池
+     * @brief LRUBufferPool 的可调参数
+     */
+    struct LRUBufferPoolOptions
+    {
+        /** 分片数量：页号哈希到各分片，每个分片拥有独立的锁、页表与替换策略 */
+        size_t shard_count = 16;
+
+        /** 缓冲池内存上限（字节），数据文件放不下时按各页大小的数据量比例分配给各页大小 */
+        size_t memory_budget = BufferPool::max_buffer_pool_size;
+
+        /**
+         * 各页大小共享内存预算：按字节而不是按每类帧数计算占用，驱逐可跨页大小进行。
+         * 分片内所有页大小共用一个策略实例，配合 gdsf 策略时优先回收大而冷的页。
+         * 帧内存按需提交，不做预先缺页
+         */
+        bool shared_class_budget = false;
+
+        /** 替换策略名称，见 ReplacementPolicyNames() */
+        std::string replacement_policy = "lru";
+
+        /** 启动时预先触发帧内存的缺页，避免请求路径上的缺页中断 */
+        bool prefault_frames = true;
+
+        /** 后台线程数（刷脏与预驱逐），0 表示关闭：驱逐遇到脏页时只能同步刷盘，空闲帧只在缺页时腾出 */
+        size_t cleaner_threads = 1;
+
+        /** 脏页比例目标（脏页数 / 驻留页数）：超过时刷脏线程扫描整个替换结构，而不只是冷端 */
+        double dirty_ratio_target = 0.1;
+
+        /** 刷脏线程每轮在替换结构冷端检查的帧比例 */
+        double cleaner_scan_fraction = 0.25;
+
+        /** 合并写回的单次 I/O 上限（字节）：刷脏线程与 FlushAll 把文件中连续的脏页合并为一次 pwritev，0 表示逐页写回 */
+        size_t max_write_bytes = 1024 * 1024;
+
+        /** 刷脏线程两轮之间的间隔（毫秒），前台驱逐遇到脏页时会提前唤醒 */
+        unsigned cleaner_interval_ms = 20;
+
+        /**
+         * 空闲帧低水位（占分片内各类帧数的比例；共享预算时为空闲字节占预算的比例）：
+         * 缺页取帧后低于此值时唤醒后台线程预先驱逐
+         */
+        double free_frames_low_watermark = 0.01;
+
+        /** 空闲帧高水位：后台线程预先驱逐干净的冷页，直到空闲帧达到此比例 */
+        double free_frames_high_watermark = 0.03;
+
+        /** 预读线程数，0 表示关闭顺序预读 */
+        size_t readahead_threads = 1;
+
+        /** 识别出顺序流后的初始预读页数 */
+        size_t readahead_initial_pages = 4;
+
+        /** 单次预读的字节上限，同时限制预读窗口的页数；一页就超过一半上限的页大小不做预读 */
+        size_t readahead_max_bytes = 1024 * 1024;
+
+        /**
+         * 磁盘 I/O 后端："io_uring"、"sync"（阻塞 preadv/pwritev），
+         * 或 "auto"：优先 io_uring，内核不支持时退回 sync
+         */
+        std::string io_backend = "auto";
+
+        /**
+         * 以 O_DIRECT 打开数据文件，绕过内核页缓存，避免同一页在页缓存与缓冲池中各缓存一份。
+         * 要求页大小是 4K 的整数倍且文件长度按 4K 对齐；文件系统不支持时退回普通 I/O
+         */
+        bool direct_io = false;
+    };
+
+    /**
+     * @brief LRUBufferPool：实现基于替换策略（默认 LRU）的缓冲池
      *
      * 特性：
      *  - 缓存最近使用的热点页；
-     *  - 当缓存容量满时，驱逐最久未使用且未被 pin 的页；
-     *  - 使用 std::shared_ptr<Page> 管理内存；
-     *  - 提供线程安全访问；
-     *  - 统计命中率；
-     *  - 使用 pread/pwrite 实现随机 I/O。
+     *  - 每种页大小（8K/16K/32K/2M）各自拥有帧容量与替换策略实例，内存预算按比例划分；
+     *  - 当某种页大小的帧用满时，由替换策略（ReplacementPolicy，可按名称选择）挑选未被 pin 的页驱逐；
+     *  - 可选各页大小共享内存预算，按字节计占用，驱逐跨页大小进行（见 shared_class_budget）；
+     *  - 所有帧在启动时从每种页大小一段连续的帧内存中切出，缺页只从空闲链表取帧，不再分配内存；
+     *  - 页表与替换策略按页号分片，各分片独立加锁，降低多线程争用；
+     *  - 磁盘读写均在分片锁外进行，慢 I/O 不阻塞其他页的命中；
+     *  - 后台刷脏线程提前写回替换结构冷端的脏页，驱逐时通常无需同步写盘；文件中连续的脏页合并为一次 pwritev；
+     *  - 按连接识别顺序读，异步把后续若干页用一次 preadv 预读进缓冲池，窗口随预读页的命中率伸缩；
+     *  - 客户端的预取提示（prefetch_pages）由同一组预读线程异步读入，不 pin，命中与浪费单独统计；
+     *  - 后台线程按高低水位预先驱逐，保持每类一定数量的空闲帧，缺页直接取帧而不运行替换逻辑；
+     *  - 磁盘 I/O 经 IoBackend 提交：默认使用 io_uring，合并写与预读的多段请求一次提交、并发执行，
+     *    帧内存注册为固定缓冲区；内核不支持时退回阻塞的 preadv/pwritev；
+     *  - 可选 O_DIRECT 绕过内核页缓存，内存预算即实际缓存占用（见 direct_io）；
+     *  - 统计命中率。
      */
     class LRUBufferPool : public BufferPool
     {
     public:
-        LRUBufferPool(std::string file_name, const std::map<size_t, size_t> &page_no_info);
+        LRUBufferPool(std::string file_name, const std::map<size_t, size_t> &page_no_info,
+                      const LRUBufferPoolOptions &options = LRUBufferPoolOptions());
         ~LRUBufferPool() override;
 
         void read_page(pageno no, unsigned int page_size, void *buf, int t_idx) override;
         void write_page(pageno no, unsigned int page_size, void *buf, int t_idx) override;
+        /// pin 住帧并持有页的共享锁调用 fn：数据直接来自帧内存，回调期间写同一页的请求等待
+        bool with_page_read(pageno no, unsigned int page_size, int t_idx,
+                            const std::function<void(const void *data, size_t len)> &fn) override;
+        /// 不在缓冲池的页先预留帧、合并为连续区间一次提交并行读盘，再按请求顺序逐页回调，fn 返回 false 时提前结束
+        void with_pages_read(const PageRequest *pages, size_t count, int t_idx,
+                             const std::function<bool(size_t i, const void *data, size_t len)> &fn) override;
+        /// pin 住帧并持有页的独占锁调用 fn 覆盖帧内存；缺页时不读盘
+        bool with_page_write(pageno no, unsigned int page_size, int t_idx,
+                             const std::function<void(void *data, size_t len)> &fn) override;
+        /// 排序去重后交给预读线程：文件中连续的缺页合并为一个读请求；队列已满或关闭预读时丢弃提示
+        void prefetch_pages(const pageno *pages, size_t count, int t_idx) override;
         void show_hit_rate() override;
 
     private:
-        std::shared_ptr<Page> GetPage(pageno no, unsigned int page_size);
-        std::shared_ptr<Page> LoadPageFromDisk(pageno no, unsigned int page_size);
-        void EvictIfNeeded();
-        void MoveToFront(pageno no);
+        /**
+         * @brief 页大小类别：页号按页大小从小到大连续编号，文件中也按此顺序连续存放
+         */
+        struct SizeClass
+        {
+            size_t page_size{0};
+            pageno first_no{0};   ///< 该类第一个页号
+            size_t page_count{0}; ///< 该类页数
+            off_t file_offset{0}; ///< 该类第一页在文件中的偏移
+            size_t capacity{0};   ///< 分配给该类的帧数（所有分片合计）
+        };
+
+        /**
+         * @brief 分片内某一页大小的帧池：每个帧要么由替换策略管理（已映射页号），要么在空闲链表
+         */
+        struct ClassFrames
+        {
+            ReplacementPolicy *policy{nullptr}; ///< 由所属分片持有；共享预算时各页大小指向同一实例
+            std::vector<Page *> free_frames;
+            std::vector<std::shared_ptr<Page>> frames; ///< 该分片拥有的全部帧描述符
+            size_t capacity{0};
+            size_t low_watermark{0};  ///< 空闲帧少于此数时唤醒后台预驱逐
+            size_t high_watermark{0}; ///< 后台预驱逐的目标空闲帧数
+        };
+
+        /**
+         * @brief 分片：独立加锁的页表 + 每种页大小的帧池
+         *
+         * 每个分片按各页大小的 capacity 计数驱逐，命中/缺页计数也按分片累加，
+         * 避免所有线程争抢同一条缓存行。
+         */
+        struct alignas(64) Shard
+        {
+            std::shared_mutex latch; ///< 命中路径在策略允许时只取共享锁
+            std::unordered_map<pageno, std::shared_ptr<Page>> page_table;
+            std::vector<ClassFrames> classes; ///< 下标与 classes_ 一致
+            std::vector<std::unique_ptr<ReplacementPolicy>> policies;
+
+            size_t resident_bytes{0};      ///< 已映射页号（含 I/O 进行中）的帧内存总量
+            size_t budget_bytes{SIZE_MAX}; ///< 共享预算时的字节上限，否则只受各类帧数限制
+            size_t low_free_bytes{0};      ///< 共享预算时的低水位（空闲字节）
+            size_t high_free_bytes{0};     ///< 共享预算时的高水位（空闲字节）
+
+            std::atomic<size_t> hit_count{0};
+            std::atomic<size_t> miss_count{0};
+
+            std::atomic<size_t> dirty_pages{0};        ///< 由各帧的 Page::set_dirty_counter 维护
+            std::atomic<size_t> cleaner_flushes{0};    ///< 刷脏线程写回的页数
+            std::atomic<size_t> eviction_flushes{0};   ///< 驱逐时同步写回的页数
+            std::atomic<size_t> inline_evictions{0};   ///< 缺页路径上驱逐的页数
+            std::atomic<size_t> background_evictions{0}; ///< 后台预驱逐的页数
+        };
+
+        /**
+         * @brief 顺序读检测状态：按连接（t_idx）哈希到固定数量的槽位
+         */
+        struct ReadaheadStream
+        {
+            std::mutex mutex;
+            pageno next{0};        ///< 顺序流的下一个期望页号
+            pageno ahead{0};       ///< 已发起预读的区间末尾（不含）
+            size_t run{0};         ///< 连续顺序访问的次数
+            size_t window{0};      ///< 当前预读窗口（页）
+            size_t used_seen{0};   ///< 上次调整窗口时的全局预读命中数
+            size_t unused_seen{0}; ///< 上次调整窗口时的全局预读浪费数
+        };
+
+        struct ReadaheadRequest
+        {
+            ReadaheadStream *stream{nullptr}; ///< 发起请求的顺序流；为空表示客户端提示
+            pageno first{0};
+            size_t count{0};
+            std::vector<pageno> hinted; ///< 客户端提示的页号（已排序去重），stream 为空时使用
+        };
+
+        Shard &ShardFor(pageno no) { return *shards_[no % shards_.size()]; }
+
+        /// 页号所属的页大小类别下标，越界返回 -1
+        int ClassIndex(pageno no) const;
+        off_t PageOffset(pageno no) const;
+
+        /**
+         * @brief 获取页面（返回时已 pin，调用方负责 unpin）
+         *
+         * 策略支持并发访问（如 CLOCK）时，命中只持有分片共享锁；
+         * 缺页时先在分片中插入 I/O 进行中的占位页并释放分片锁，再读盘；
+         * 同一页的并发请求直接拿到占位页，在其页锁上等待加载完成。
+         * overwrite 非空表示调用方将覆盖整页：缺页时不读盘，置 *overwrite = true 并返回仍处于
+         * I/O 进行中的占位页（独占锁由调用方持有），调用方填充整页后调用 end_io()
+         */
+        std::shared_ptr<Page> GetPage(pageno no, unsigned int page_size, bool *overwrite = nullptr);
+        bool LoadPageFromDisk(const std::shared_ptr<Page> &page);
+
+        /// EvictIfNeeded 的结果
+        enum class Eviction
+        {
+            kReady,  ///< 已有空闲帧（及字节余量）
+            kRetry,  ///< 驱逐了一页或期间释放过分片锁，调用方需重新检查页表后再调用
+            kFailed, ///< 脏页写回屡次失败，放弃本次缺页
+        };
+        /// 保证有空闲帧（及共享预算下的字节余量）。写回失败的脏页保持 pin 住放进 unflushable，
+        /// 本次缺页后续的挑选跳过它们；失败次数达到上限，或其余的页都被 pin 时返回 kFailed
+        Eviction EvictIfNeeded(Shard &shard, ClassFrames &frames, pageno incoming,
+                               std::unique_lock<std::shared_mutex> &lock, std::vector<Page::PinGuard> &unflushable);
+        /// 由替换策略选出驱逐页，优先干净页；候选都是脏页时返回其中一个脏页，全部被 pin 时返回 nullptr
+        Page *PickVictim(ClassFrames &frames, pageno incoming);
+        /// 把干净的 victim 移出页表与策略、放回空闲链表；帧内存不是留给 keep_for 复用时归还给内核
+        void EvictPage(Shard &shard, Page *victim, const ClassFrames *keep_for);
+        /// 取一个空闲帧作为 no 的"I/O 进行中"占位页插入页表（调用方持有分片独占锁且已保证有空闲帧），返回时已 pin
+        std::shared_ptr<Page> InstallFrame(Shard &shard, ClassFrames &frames, pageno no);
+
+        /// 记录连接 t_idx 读取了 no；识别出顺序流且预读窗口将被读完时，把下一段加入预读队列
+        void DetectSequential(pageno no, int t_idx);
+        void ReadaheadLoop();
+        /// 为有序页号 nos 中不在缓冲池的页预留帧，文件中每个连续区间一个读请求，一次提交读入
+        void Prefetch(const std::vector<pageno> &nos, Page::Prefetch source);
+        /// 不等待、不同步刷盘地为 no 预留占位帧（已 pin）；页已存在或没有可立即驱逐的干净页时返回 nullptr。
+        /// 按 source 打上预读标记，kNotPrefetched 时计为一次缺页
+        std::shared_ptr<Page> TryReserveFrame(pageno no, Page::Prefetch source);
+        /// 读入若干段文件中连续的占位页（每段一个读请求，一次提交）并结束其 I/O；
+        /// 预读时随后 unpin 并按 source 计入预读页数，kNotPrefetched 时页仍由调用方 pin 住
+        void ReadRuns(std::vector<std::vector<std::shared_ptr<Page>>> &runs, Page::Prefetch source);
+        /// 页被请求访问（used）或被驱逐时结算其预读标记
+        void SettlePrefetch(Page *page, bool used);
+        void StopReadahead();
         bool FlushPage(std::shared_ptr<Page> page);
         void FlushAll();
 
+        /// 刷脏线程主循环：把数据文件均分为 stride 段，写回第 worker 段中的脏页（各分片都要收集，
+        /// 文件中相邻的页才能落在同一批里合并）；预驱逐负责下标 worker, worker + stride, ... 的分片
+        void CleanerLoop(size_t worker, size_t stride);
+        /// 收集分片冷端（脏页比例超标时为全部）中文件偏移落在 [begin, end) 的未被 pin 的脏页，pin 住后追加到 batch
+        void CollectDirtyPages(Shard &shard, off_t begin, off_t end, std::vector<std::shared_ptr<Page>> &batch);
+        /// 按文件偏移排序后把连续的脏页合并为一个写请求，分批提交给 I/O 后端（调用方已 pin 住 pages），返回写回的页数；
+        /// written_pages 非空时追加本次实际写回的页（已被其他线程写回或写盘失败的页不在其中）
+        size_t FlushCoalesced(std::vector<std::shared_ptr<Page>> &pages, std::vector<Page *> *written_pages = nullptr);
+        /// 空闲帧低于高水位时预先驱逐干净的冷页，返回驱逐的页数
+        size_t ReplenishShard(Shard &shard);
+        /// 唤醒刷脏线程（前台驱逐遇到脏页时调用）
+        void WakeCleaners();
+        void StopCleaners();
+
     private:
         int fd_{-1};
-        size_t capacity_{0};
-        size_t page_size_{0};
+        bool direct_io_{false}; ///< 数据文件以 O_DIRECT 打开
+        std::unique_ptr<IoBackend> io_;
+
+        std::vector<SizeClass> classes_;
+        bool shared_budget_{false};
+        std::vector<std::unique_ptr<FrameArena>> arenas_; ///< 下标与 classes_ 一致，须晚于帧描述符析构
+        std::vector<std::unique_ptr<Shard>> shards_;
 
-        std::unordered_map<pageno, std::shared_ptr<Page>> page_table_;
-        std::list<pageno> lru_list_;
-        std::mutex latch_;
+        double dirty_ratio_target_{0};
+        double cleaner_scan_fraction_{0};
+        size_t max_write_bytes_{0};
+        bool background_eviction_{false};
+        std::chrono::milliseconds cleaner_interval_{0};
+        std::vector<std::thread> cleaners_;
+        std::mutex cleaner_mutex_;
+        std::condition_variable cleaner_cv_;
+        uint64_t cleaner_wakeups_{0}; ///< 由 cleaner_mutex_ 保护，每次唤醒加一
+        bool stop_cleaners_{false};   ///< 由 cleaner_mutex_ 保护
 
-        std::atomic<size_t> hit_count_{0};
-        std::atomic<size_t> miss_count_{0};
+        size_t readahead_initial_pages_{0};
+        size_t readahead_max_bytes_{0};
+        std::unique_ptr<ReadaheadStream[]> streams_;
+        std::vector<std::thread> readahead_threads_;
+        std::mutex readahead_mutex_;
+        std::condition_variable readahead_cv_;
+        std::deque<ReadaheadRequest> readahead_queue_; ///< 由 readahead_mutex_ 保护
+        bool stop_readahead_{false};                   ///< 由 readahead_mutex_ 保护
+        std::atomic<size_t> readahead_pages_{0};  ///< 预读载入的页数
+        std::atomic<size_t> readahead_used_{0};   ///< 预读页被请求访问的次数（每页至多一次）
+        std::atomic<size_t> readahead_unused_{0}; ///< 预读页未被访问就被驱逐的次数
+        std::atomic<size_t> hinted_pages_{0};     ///< 按客户端提示载入的页数
+        std::atomic<size_t> hinted_used_{0};      ///< 提示载入的页被请求访问的次数（每页至多一次）
+        std::atomic<size_t> hinted_unused_{0};    ///< 提示载入的页未被访问就被驱逐的次数
+        std::atomic<size_t> hints_dropped_{0};    ///< 预读队列已满而丢弃的提示数
+        std::atomic<size_t> blind_writes_{0};     ///< 整页写缺页时跳过读盘、并已填充完成的次数
     };
 
 } // namespace gaussdb::buffer
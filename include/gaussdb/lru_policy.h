@@ -0,0 +1,48 @@
+#pragma once
+#include "gaussdb/replacement_policy.h"
+#include "gaussdb/page_list.h"
+
+namespace gaussdb::buffer
+{
+
+    /**
+     * @brief LRUPolicy：最近最少使用
+     *
+     * 命中移到热端，从冷端选择第一个未被 pin 的页驱逐，均为 O(1)（跳过 pin 的页除外）。
+     */
+    class LRUPolicy : public ReplacementPolicy
+    {
+    public:
+        explicit LRUPolicy(size_t capacity);
+
+        const char *name() const noexcept override { return "lru"; }
+        void RecordAccess(Page *page) override;
+        void Insert(Page *page) override;
+        Page *PickVictim(pageno incoming) override;
+        void Remove(Page *page) override;
+        void ColdPages(size_t max, std::vector<Page *> &out) const override;
+
+    private:
+        PageList lru_list_;
+    };
+
+    /**
+     * @brief FIFOPolicy：先进先出，命中不调整顺序，作为对比基线
+     */
+    class FIFOPolicy : public ReplacementPolicy
+    {
+    public:
+        explicit FIFOPolicy(size_t capacity);
+
+        const char *name() const noexcept override { return "fifo"; }
+        void RecordAccess(Page *page) override;
+        void Insert(Page *page) override;
+        Page *PickVictim(pageno incoming) override;
+        void Remove(Page *page) override;
+        void ColdPages(size_t max, std::vector<Page *> &out) const override;
+
+    private:
+        PageList fifo_list_;
+    };
+
+} // namespace gaussdb::buffer
@@ -6,6 +6,7 @@
 #include <shared_mutex>
 #include <functional>
 #include <string>
+#include <mutex>
 
 namespace gaussdb::buffer
 {
@@ -18,7 +19,7 @@ namespace gaussdb::buffer
      *
      * 特性：
      *  - 每个 Page 对应唯一的页号 (page_id) 和固定的页大小。
-     *  - 持有实际数据缓冲区（data_），由智能指针管理生命周期。
+     *  - 持有实际数据缓冲区（data_），可自行分配，也可引用缓冲池预分配的帧内存（不拥有）。
      *  - 提供线程安全的读写接口：多线程可并发读，写操作互斥。
      *  - 维护 pin_count（页面被使用的引用计数），供缓存淘汰算法判断是否可驱逐。
      *  - 维护 dirty / loaded 状态，用于区分是否需要写回磁盘。
@@ -27,7 +28,7 @@ namespace gaussdb::buffer
      * 线程安全说明：
      *  - pin()/unpin() 使用原子操作，可在多线程下安全调用。
      *  - ReadAt() 使用 shared_lock 共享读锁，可并行读取。
-     *  - WriteAt()/load_from_fd() 使用 unique_lock 独占锁，保证写入一致性。
+     *  - WriteAt() 使用 unique_lock 独占锁，保证写入一致性。
      *  - flush_to_fd() 在持有读锁时复制数据，避免长时间阻塞读者。
      */
     class Page : public std::enable_shared_from_this<Page>
@@ -43,6 +44,12 @@ namespace gaussdb::buffer
          * @param flush_cb 可选刷盘回调（供 BufferPool 注入）
          */
         Page(page_id_t id, size_t page_size, FlushCallback flush_cb = nullptr);
+
+        /**
+         * @brief 构造引用外部帧内存的页面（不分配、不清零）
+         * @param frame 帧缓冲区，至少 page_size 字节，生命周期需长于 Page；为空时自行分配
+         */
+        Page(page_id_t id, size_t page_size, byte *frame);
         ~Page();
 
         // 禁止拷贝，避免无意复制大块内存
@@ -52,8 +59,14 @@ namespace gaussdb::buffer
         // 基本访问接口
         page_id_t id() const noexcept { return page_id_; }
         size_t size() const noexcept { return page_size_; }
-        byte *data() noexcept { return data_.get(); }
-        const byte *data() const noexcept { return data_.get(); }
+        byte *data() noexcept { return data_; }
+        const byte *data() const noexcept { return data_; }
+
+        /**
+         * @brief 复用帧：改为承载另一页号，清除 dirty / loaded 等状态
+         * @note 仅可在 pin_count 为 0 且不在页表中时调用（由缓冲池保证）
+         */
+        void reset(page_id_t id) noexcept;
 
         // ======================
         // 引用计数 (pin/unpin)
@@ -104,12 +117,15 @@ namespace gaussdb::buffer
         // ======================
 
         /**
-         * @brief 从文件加载页面数据
-         * @param fd 文件描述符
-         * @param file_offset 页在文件中的字节偏移
-         * @return true 表示读取成功（即使读到 EOF 也会填充 0）
+         * @brief 进入 I/O 进行中状态：获取独占锁，直到 end_io() 释放
+         * @note 缓冲池在分片锁内对新插入的占位页调用，之后即可释放分片锁再读盘
          */
-        bool load_from_fd(int fd, off_t file_offset);
+        void begin_io();
+
+        /**
+         * @brief 结束 I/O 进行中状态并释放独占锁，唤醒在该页上等待的访问者
+         */
+        void end_io();
 
         /**
          * @brief 将页面内容写回文件
@@ -130,8 +146,17 @@ namespace gaussdb::buffer
         // ======================
         bool is_dirty() const noexcept { return dirty_.load(std::memory_order_acquire); }
         bool is_loaded() const noexcept { return loaded_.load(std::memory_order_acquire); }
-        void mark_dirty() noexcept { dirty_.store(true, std::memory_order_release); }
-        void clear_dirty() noexcept { dirty_.store(false, std::memory_order_release); }
+        bool io_in_progress() const noexcept { return io_in_progress_.load(std::memory_order_acquire); }
+        void mark_dirty() noexcept { update_dirty(true); }
+        /// 数据已由调用方直接填充（例如读盘失败时的全零页）
+        void mark_loaded() noexcept { loaded_.store(true, std::memory_order_release); }
+        void clear_dirty() noexcept { update_dirty(false); }
+
+        /**
+         * @brief 关联脏页计数器：dirty 状态每次由假变真加一、由真变假减一
+         * @note 缓冲池据此维护各分片的脏页数，应在帧投入使用前设置
+         */
+        void set_dirty_counter(std::atomic<size_t> *counter) noexcept { dirty_counter_ = counter; }
 
         void set_lsn(uint64_t lsn) noexcept { lsn_ = lsn; }
         uint64_t lsn() const noexcept { return lsn_; }
@@ -154,6 +179,8 @@ namespace gaussdb::buffer
                 if (page)
                     page->pin();
             }
+            /// 接管调用方已持有的 pin（例如 BufferPool 返回的已 pin 页面）
+            PinGuard(std::shared_ptr<Page> p, std::adopt_lock_t) : page(std::move(p)) {}
             ~PinGuard()
             {
                 if (page)
@@ -168,19 +195,71 @@ namespace gaussdb::buffer
             std::shared_ptr<Page> page;
         };
 
+        // ======================
+        // 侵入式链表挂钩
+        // ======================
+
+        /**
+         * @brief ListHook: 供缓冲池的替换链表（见 PageList）使用的前后指针，
+         * 使链表的提升、摘除都不需要遍历；另带少量由替换策略维护的逐帧元数据
+         */
+        struct ListHook
+        {
+            Page *prev{nullptr};
+            Page *next{nullptr};
+            bool linked{false};
+            uint8_t queue{0};      ///< 所在队列编号，由替换策略自行解释
+            uint32_t frequency{0}; ///< 访问计数，由替换策略自行维护
+            double priority{0};    ///< 驱逐优先级，由替换策略自行维护
+        };
+
+        ListHook &list_hook() noexcept { return list_hook_; }
+
+        /// 预读标记的来源
+        enum Prefetch : uint8_t
+        {
+            kNotPrefetched = 0,
+            kReadahead = 1, ///< 顺序预读
+            kHinted = 2,    ///< 客户端提示（BufferPool::prefetch_pages）
+        };
+
+        /// 预读标记：页由预读载入、尚未被请求访问过
+        void set_prefetched(Prefetch source) noexcept { prefetched_.store(source, std::memory_order_relaxed); }
+        /// 读取并清除预读标记，返回其来源；未标记时只读不写，命中路径不会争抢缓存行
+        Prefetch take_prefetched() noexcept
+        {
+            if (prefetched_.load(std::memory_order_relaxed) == kNotPrefetched)
+                return kNotPrefetched;
+            return static_cast<Prefetch>(prefetched_.exchange(kNotPrefetched, std::memory_order_relaxed));
+        }
+
+        /// 访问位（CLOCK 等策略使用）：命中路径只做一次 relaxed 原子写，无需独占锁
+        void set_referenced() noexcept { referenced_.store(true, std::memory_order_relaxed); }
+        /// 读取并清除访问位，返回清除前的值
+        bool clear_referenced() noexcept { return referenced_.exchange(false, std::memory_order_relaxed); }
+
         /// 获取内部共享锁对象（高级用法：可在外部手动加锁）
         std::shared_mutex &latch() const noexcept { return latch_; }
 
     private:
+        /// 修改 dirty 状态，并在状态翻转时同步脏页计数器
+        void update_dirty(bool dirty) noexcept;
+
         page_id_t page_id_;
         size_t page_size_;
-        std::unique_ptr<byte[]> data_; ///< 实际页面数据缓冲区
+        std::unique_ptr<byte[]> owned_data_; ///< 自行分配时的缓冲区
+        byte *data_;                         ///< 实际页面数据缓冲区（自有或外部帧）
 
         // 元数据
         std::atomic<int> pin_count_{0}; ///< 当前 pin 次数
         std::atomic<bool> dirty_{false};
+        std::atomic<size_t> *dirty_counter_{nullptr}; ///< 可选，见 set_dirty_counter
         std::atomic<bool> loaded_{false};
+        std::atomic<bool> io_in_progress_{false};
         uint64_t lsn_{0}; ///< 可选的日志序号（恢复用）
+        ListHook list_hook_; ///< 由持有者的锁保护
+        std::atomic<bool> referenced_{false};
+        std::atomic<uint8_t> prefetched_{kNotPrefetched};
 
         // 读写锁：允许多读单写
         mutable std::shared_mutex latch_;
@@ -0,0 +1,57 @@
+#pragma once
+#include "gaussdb/page.h"
+
+#include <cstddef>
+#include <vector>
+
+namespace gaussdb::buffer
+{
+
+    /**
+     * @brief PageList：基于 Page::ListHook 的侵入式双向链表
+     *
+     * 特性：
+     *  - 节点即 Page 本身，插入、摘除、移动到表头均为 O(1)；
+     *  - 不持有 Page 的所有权，生命周期由页表中的 shared_ptr 管理；
+     *  - 一个 Page 同一时刻只能挂在一条链表上；
+     *  - 非线程安全，由调用方（分片锁）保护。
+     *
+     * 约定 front 为最近访问端（热端），back 为最久未访问端（冷端）。
+     */
+    class PageList
+    {
+    public:
+        PageList() = default;
+        PageList(const PageList &) = delete;
+        PageList &operator=(const PageList &) = delete;
+
+        void push_front(Page *page) noexcept;
+        void push_back(Page *page) noexcept;
+        /// 将 page 插入到 pos 之前（pos 为空时等同 push_back）
+        void insert_before(Page *pos, Page *page) noexcept;
+        void erase(Page *page) noexcept;
+        void move_to_front(Page *page) noexcept;
+
+        Page *front() const noexcept { return head_; }
+        Page *back() const noexcept { return tail_; }
+        /// 从冷端向热端遍历时的下一个节点
+        static Page *prev(Page *page) noexcept { return page->list_hook().prev; }
+        /// 从热端向冷端遍历时的下一个节点
+        static Page *next(Page *page) noexcept { return page->list_hook().next; }
+
+        /// 从冷端向热端找第一个未被 pin 的页（驱逐候选），没有则返回 nullptr
+        Page *back_unpinned() const noexcept;
+
+        /// 从冷端向热端追加至多 max 个页到 out
+        void collect_back(std::vector<Page *> &out, size_t max) const;
+
+        size_t size() const noexcept { return size_; }
+        bool empty() const noexcept { return size_ == 0; }
+
+    private:
+        Page *head_{nullptr};
+        Page *tail_{nullptr};
+        size_t size_{0};
+    };
+
+} // namespace gaussdb::buffer
@@ -0,0 +1,80 @@
+#pragma once
+#include "gaussdb/page.h"
+#include "gaussdb/buffer_pool.h"
+
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace gaussdb::buffer
+{
+
+    /// PickVictim 的 incoming 取值：后台预驱逐，没有触发驱逐的缺页页号
+    inline constexpr pageno kNoIncomingPage = static_cast<pageno>(-1);
+
+    /**
+     * @brief ReplacementPolicy：缓冲池替换策略接口
+     *
+     * 约定：
+     *  - 缓冲池为每个分片的每种页大小各创建一个实例，capacity 为该实例管理的帧数；
+     *  - 所有回调都在所属分片的独占锁内调用，实现无需自行加锁；
+     *    例外：concurrent_access() 返回 true 的策略，其 RecordAccess 在分片共享锁下被并发调用；
+     *  - 策略只记录已映射页号的帧，帧的所有权与页表由缓冲池管理；
+     *  - 每条链表挂钩使用 Page::list_hook()，一个帧同一时刻只挂在一条链表上。
+     */
+    class ReplacementPolicy
+    {
+    public:
+        virtual ~ReplacementPolicy() = default;
+
+        /// 策略名称（与 MakeReplacementPolicy 的参数一致）
+        virtual const char *name() const noexcept = 0;
+
+        /**
+         * @brief RecordAccess 是否可在分片共享锁下并发调用
+         * @note 返回 true 时命中路径不再获取独占锁，实现只能修改原子的逐帧状态
+         */
+        virtual bool concurrent_access() const noexcept { return false; }
+
+        /// 命中：页面被再次访问
+        virtual void RecordAccess(Page *page) = 0;
+
+        /// 缺页：帧刚映射到新页号（此时 I/O 可能仍在进行）
+        virtual void Insert(Page *page) = 0;
+
+        /**
+         * @brief 选择驱逐页，但不从策略中移除
+         * @param incoming 触发驱逐的缺页页号（部分策略据此调整），后台预驱逐时为 kNoIncomingPage
+         * @return 未被 pin 的候选页；全部被 pin 时返回 nullptr
+         * @note 候选页若为脏页，缓冲池会先刷盘再重新调用本函数
+         */
+        virtual Page *PickVictim(pageno incoming) = 0;
+
+        /// 页面被驱逐：从策略中移除
+        virtual void Remove(Page *page) = 0;
+
+        /**
+         * @brief 按大致的驱逐顺序（最冷在前）向 out 追加至多 max 个驻留页，不改变策略状态
+         * @note 供后台刷脏线程提前写回即将被驱逐的脏页，返回的页可能被 pin
+         */
+        virtual void ColdPages(size_t max, std::vector<Page *> &out) const = 0;
+
+        /**
+         * @brief 累加策略的可观测参数（例如 ARC 的目标值 p），由 show_hit_rate 按页大小汇总输出
+         * @note 多个实例向同一个 map 累加，请使用 += 而不是覆盖
+         */
+        virtual void CollectStats(std::map<std::string, double> & /*stats*/) const {}
+    };
+
+    /// 可选的策略名称
+    std::vector<std::string> ReplacementPolicyNames();
+
+    /**
+     * @brief 按名称创建替换策略
+     * @throw std::invalid_argument 未知的策略名称
+     */
+    std::unique_ptr<ReplacementPolicy> MakeReplacementPolicy(const std::string &name, size_t capacity);
+
+} // namespace gaussdb::buffer
@@ -1,26 +1,54 @@
 #pragma once
 #include "gaussdb/buffer_pool.h"
+#include <cstddef>
 #include <string>
 
 namespace gaussdb::server
 {
 
+    /**
+     * @brief Server 的可调参数
+     */
+    struct ServerOptions
+    {
+        /**
+         * epoll reactor 线程数：负责 accept 与解析请求头，解析完成后交给工作线程。
+         * 0 表示沿用每连接一个线程的模式
+         */
+        size_t reactor_threads = 1;
+
+        /** 事件模式下执行缓冲池调用并收发页面数据的工作线程数 */
+        size_t worker_threads = 8;
+    };
+
     /**
      * Server - 使用 UNIX domain socket 监听请求并调用 BufferPool 接口。
      * 头文件只声明类接口，具体实现放在 src/server.cpp。
+     *
+     * 两种模式：
+     *  - 事件模式（默认）：少量 epoll reactor 线程处理连接就绪与请求头的增量解析，
+     *    完整的请求交给固定大小的工作线程池；连接数与线程数无关；
+     *  - 线程模式（reactor_threads = 0）：每个连接一个线程，已结束的线程在 accept 时回收。
+     *
+     * 请求类型带 0x80 标志时头部后跟 4 字节请求 ID，应答以该 ID 开头：事件模式下同一连接的
+     * 这类请求并发执行、按完成顺序应答；线程模式下按顺序处理。
      */
     class Server
     {
     public:
-        explicit Server(gaussdb::buffer::BufferPool *bp, const char *socket_file);
+        explicit Server(gaussdb::buffer::BufferPool *bp, const char *socket_file,
+                        const ServerOptions &options = ServerOptions());
         ~Server();
 
         // 创建 socket 并 bind（返回 0 表示成功）
         int create_socket();
 
-        // 进入主循环，阻塞直到退出（SIGINT 等会设置全局标志）
+        // 进入主循环，阻塞直到 request_shutdown() 被调用
         void listen_forever();
 
+        // 请求退出主循环：只做异步信号安全的操作，可在信号处理函数中调用
+        static void request_shutdown() noexcept;
+
     private:
         // 不将实现细节暴露在头文件中
         struct Impl;
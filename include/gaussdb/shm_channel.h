@@ -0,0 +1,125 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+
+namespace gaussdb::server
+{
+
+    /*
+     * 共享内存数据通道的内存布局，客户端按同样的定义访问映射区域。
+     *
+     * 建立：客户端在 socket 上发送不带请求 ID 的 ATTACH 请求（page_no = 槽位数，page_size = 槽位大小），
+     * 服务端创建 memfd、按下述布局初始化，应答 4 字节的区域大小并以 SCM_RIGHTS 附带 memfd；
+     * 大小为 0 表示创建失败（连接上仍有其他请求在途时同样拒绝），连接继续使用 socket 协议。
+     * 之后 socket 只用于唤醒：
+     *  - 提交：客户端把 ShmRequest 写入提交队列第 tail % entries 项后推进 sq.tail，
+     *    若 sq.waiting 原为 1（exchange 为 0）则向 socket 写 1 字节唤醒服务端；
+     *  - 完成：服务端把 ShmCompletion 写入完成队列后推进 cq.tail，客户端置位 cq.waiting 并复查队列后，
+     *    才可在 socket 上阻塞读，服务端看到 waiting 时写 1 字节唤醒；
+     *  - 同一时刻在途的请求不得超过 entries 个，完成队列因此不会溢出；每个在途请求使用自己的槽位。
+     * 所有 head/tail/waiting 的读写使用顺序一致的原子操作，保证"置位后复查"与"推进后检查"不会互相错过。
+     */
+
+    constexpr uint32_t kShmMagic = 0x474d5348; // "HSMG"
+    constexpr uint32_t kShmMaxEntries = 1024;
+
+    /// 环形队列的位置：消费者写 head/waiting，生产者写 tail，分处两个缓存行
+    struct ShmRing
+    {
+        alignas(64) std::atomic<uint32_t> head;
+        std::atomic<uint32_t> waiting; ///< 消费者即将在 socket 上阻塞，生产者须唤醒它
+        alignas(64) std::atomic<uint32_t> tail;
+    };
+
+    /// 提交队列项：msg_type 取 socket 协议中的 GET(0) / SET(1)
+    struct ShmRequest
+    {
+        uint8_t msg_type;
+        uint8_t reserved[3];
+        uint32_t page_no;
+        uint32_t page_size;
+        uint32_t slot;      ///< GET 把页面写入该槽位，SET 从该槽位读取页面
+        uint64_t user_data; ///< 原样带回完成队列
+    };
+
+    /// 完成队列项：result 为 page_size 表示成功，负值为 -errno（EINVAL 请求无效，EIO 页面不可用）
+    struct ShmCompletion
+    {
+        uint64_t user_data;
+        int32_t result;
+        uint32_t reserved;
+    };
+
+    /// 区域开头的控制块；各部分的偏移量相对区域起始地址
+    struct ShmRegionHeader
+    {
+        uint32_t magic;
+        uint32_t entries;   ///< 队列容量与槽位数（2 的幂）
+        uint32_t slot_size; ///< 每个槽位的字节数
+        uint32_t reserved;
+        uint64_t sq_offset;    ///< ShmRequest[entries]
+        uint64_t cq_offset;    ///< ShmCompletion[entries]
+        uint64_t slots_offset; ///< entries 个槽位，按系统页对齐
+        uint64_t size;         ///< 区域总字节数
+        ShmRing sq;
+        ShmRing cq;
+    };
+
+    static_assert(std::atomic<uint32_t>::is_always_lock_free, "shared rings need address-free atomics");
+
+    /**
+     * @brief ShmChannel：服务端一侧的共享内存通道
+     *
+     * 特性：
+     *  - 区域由 memfd 承载并加封 F_SEAL_SHRINK/F_SEAL_GROW，客户端无法截断文件让服务端访问时收到 SIGBUS；
+     *  - 提交队列只有一个消费者（持有连接输入的线程），无需加锁；
+     *  - 完成队列可由多个工作线程并发写入，生产端在服务端内部加锁，与客户端之间仍是无锁的；
+     *  - 客户端写入的 head/tail/槽位号都视为不可信输入，越界时报告协议错误而不是越界访问。
+     */
+    class ShmChannel
+    {
+    public:
+        /**
+         * @brief 创建 entries（向上取 2 的幂）个槽位、每个 slot_size 字节的区域
+         * @throw std::invalid_argument 参数越界；std::runtime_error memfd 创建或映射失败
+         */
+        ShmChannel(uint32_t entries, uint32_t slot_size);
+        ~ShmChannel();
+
+        ShmChannel(const ShmChannel &) = delete;
+        ShmChannel &operator=(const ShmChannel &) = delete;
+
+        /// memfd，发送给客户端后即可 CloseFd()，映射仍然有效
+        int fd() const noexcept { return fd_; }
+        void CloseFd() noexcept;
+        size_t size() const noexcept { return size_; }
+        uint32_t entries() const noexcept { return entries_; }
+        uint32_t slot_size() const noexcept { return slot_size_; }
+        unsigned char *slot(uint32_t index) const noexcept { return slots_ + static_cast<size_t>(index) * slot_size_; }
+
+        /// 取出一个请求：1 取到，0 队列为空，-1 客户端写坏了队列位置
+        int Pop(ShmRequest &req);
+        /// 准备在 socket 上等待：置位 sq.waiting 后复查，队列仍为空时返回 true
+        bool PrepareSleep();
+        /// 写入一个完成项，完成队列已满（客户端超出在途上限）时返回 false
+        bool Post(const ShmCompletion &completion);
+        /// 客户端在等待完成事件时清除其标志并返回 true，调用方随后向 socket 写 1 字节
+        bool TakeWaiter();
+
+    private:
+        int fd_{-1};
+        size_t size_{0};
+        uint32_t entries_{0};
+        uint32_t slot_size_{0};
+        ShmRegionHeader *header_{nullptr};
+        ShmRequest *sq_{nullptr};
+        ShmCompletion *cq_{nullptr};
+        unsigned char *slots_{nullptr};
+        uint32_t sq_head_{0}; ///< 服务端自己的消费位置，不从共享内存读回
+        uint32_t cq_tail_{0}; ///< 服务端自己的生产位置，由 cq_mutex_ 保护
+        std::mutex cq_mutex_;
+    };
+
+} // namespace gaussdb::server
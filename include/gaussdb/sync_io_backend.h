@@ -0,0 +1,23 @@
+#pragma once
+#include "gaussdb/io_backend.h"
+
+namespace gaussdb::buffer
+{
+
+    /**
+     * @brief SyncIoBackend：在调用线程上逐个执行 preadv/pwritev
+     *
+     * 不依赖内核特性，作为 io_uring 不可用时的后备；同一批请求按顺序执行，
+     * I/O 并发度等于同时调用 Submit 的线程数。
+     */
+    class SyncIoBackend : public IoBackend
+    {
+    public:
+        const char *name() const noexcept override { return "sync"; }
+        void Submit(IoRequest *reqs, size_t count) override;
+
+        /// 执行单个请求直到全部完成（处理部分读写与 EINTR）
+        static bool Execute(IoRequest &req);
+    };
+
+} // namespace gaussdb::buffer
@@ -0,0 +1,54 @@
+#pragma once
+#include "gaussdb/replacement_policy.h"
+#include "gaussdb/page_list.h"
+#include "gaussdb/frequency_sketch.h"
+
+namespace gaussdb::buffer
+{
+
+    /**
+     * @brief TinyLFUPolicy：W-TinyLFU 替换（窗口 LRU + TinyLFU 准入 + 分段 LRU 主区）
+     *
+     * 特性：
+     *  - 每次访问（命中与缺页）都计入 FrequencySketch，草图周期性老化；
+     *  - 新页先进入窗口 LRU（约 1% 容量），吸收短时间的突发访问；
+     *  - 窗口满时，其冷端页作为候选与主区的驱逐页比较估计频率：
+     *    候选更高才进入主区试用段并驱逐主区页，否则直接驱逐候选（准入失败）；
+     *  - 主区为分段 LRU：试用段（probation）中再次命中的页提升到保护段（protected，约 80% 主区），
+     *    保护段溢出时把冷端页降级回试用段。
+     *
+     * 偏斜（Zipf）负载下，低频页无法挤掉高频页，且不增加帧内存。
+     */
+    class TinyLFUPolicy : public ReplacementPolicy
+    {
+    public:
+        explicit TinyLFUPolicy(size_t capacity);
+
+        const char *name() const noexcept override { return "tinylfu"; }
+        void RecordAccess(Page *page) override;
+        void Insert(Page *page) override;
+        Page *PickVictim(pageno incoming) override;
+        void Remove(Page *page) override;
+        void ColdPages(size_t max, std::vector<Page *> &out) const override;
+
+    private:
+        /// Page::ListHook::queue 的取值
+        enum Queue : uint8_t
+        {
+            kWindow = 1,
+            kProbation = 2,
+            kProtected = 3,
+        };
+
+        PageList &ListOf(Page *page) noexcept;
+        Page *MainVictim() const noexcept;
+
+        size_t window_capacity_;
+        size_t protected_capacity_;
+        PageList window_;
+        PageList probation_;
+        PageList protected_;
+        FrequencySketch sketch_;
+    };
+
+} // namespace gaussdb::buffer
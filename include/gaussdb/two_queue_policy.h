@@ -0,0 +1,46 @@
+#pragma once
+#include "gaussdb/replacement_policy.h"
+#include "gaussdb/page_list.h"
+#include "gaussdb/ghost_list.h"
+
+namespace gaussdb::buffer
+{
+
+    /**
+     * @brief TwoQueuePolicy：抗扫描的 2Q 替换（Johnson & Shasha, full 2Q）
+     *
+     * 特性：
+     *  - 新页先进入试用队列 A1in（FIFO），其中的命中不提升，一次性扫描的页在这里就被淘汰；
+     *  - A1in 中被驱逐的页号记入幽灵队列 A1out（只存页号，最多容量的 1/2）；
+     *  - 缺页时若页号仍在 A1out，说明被重复使用，直接进入热队列 Am（LRU）；
+     *  - A1in 超过 Kin（容量的 1/4）时优先从 A1in 驱逐，否则从 Am 的冷端驱逐。
+     *
+     * 这样全表扫描只会在 A1in 中轮转，不会冲掉 Am 中的热点页。
+     */
+    class TwoQueuePolicy : public ReplacementPolicy
+    {
+    public:
+        explicit TwoQueuePolicy(size_t capacity);
+
+        const char *name() const noexcept override { return "2q"; }
+        void RecordAccess(Page *page) override;
+        void Insert(Page *page) override;
+        Page *PickVictim(pageno incoming) override;
+        void Remove(Page *page) override;
+        void ColdPages(size_t max, std::vector<Page *> &out) const override;
+
+    private:
+        /// Page::ListHook::queue 的取值
+        enum Queue : uint8_t
+        {
+            kA1in = 1,
+            kAm = 2,
+        };
+
+        size_t kin_;         ///< A1in 目标长度
+        PageList a1in_;      ///< 试用队列（FIFO）
+        PageList am_;        ///< 热队列（LRU）
+        GhostList a1out_;    ///< 从 A1in 驱逐的页号
+    };
+
+} // namespace gaussdb::buffer
@@ -0,0 +1,122 @@
+#include "gaussdb/arc_policy.h"
+
+#include <algorithm>
+
+namespace gaussdb::buffer
+{
+
+    ARCPolicy::ARCPolicy(size_t capacity)
+        : capacity_(static_cast<double>(std::max<size_t>(1, capacity)))
+    {
+    }
+
+    void ARCPolicy::RecordAccess(Page *page)
+    {
+        // 再次访问：无论在 T1 还是 T2，都进入 T2 的热端
+        if (page->list_hook().queue == kT1)
+        {
+            t1_.erase(page);
+            t2_.push_front(page);
+            page->list_hook().queue = kT2;
+        }
+        else
+        {
+            t2_.move_to_front(page);
+        }
+    }
+
+    double ARCPolicy::AdaptedTarget(pageno incoming) const
+    {
+        double b1 = static_cast<double>(b1_.size());
+        double b2 = static_cast<double>(b2_.size());
+        if (b1_.contains(incoming))
+            return std::min(capacity_, target_ + std::max(b2 / b1, 1.0));
+        if (b2_.contains(incoming))
+            return std::max(0.0, target_ - std::max(b1 / b2, 1.0));
+        return target_;
+    }
+
+    void ARCPolicy::Insert(Page *page)
+    {
+        pageno no = page->id();
+        target_ = AdaptedTarget(no);
+        if (b1_.erase(no) || b2_.erase(no))
+        {
+            // 幽灵命中：该页近期被使用过两次，直接进入 T2
+            t2_.push_front(page);
+            page->list_hook().queue = kT2;
+        }
+        else
+        {
+            t1_.push_front(page);
+            page->list_hook().queue = kT1;
+        }
+        TrimGhosts();
+    }
+
+    Page *ARCPolicy::PickVictim(pageno incoming)
+    {
+        // ARC 的 REPLACE：缺页尚未插入，按它调整后的 p 决定从 T1 还是 T2 驱逐
+        double p = AdaptedTarget(incoming);
+        double t1 = static_cast<double>(t1_.size());
+        bool from_t1 = !t1_.empty() && (t1 > p || (b2_.contains(incoming) && t1 == p));
+
+        Page *victim = from_t1 ? t1_.back_unpinned() : t2_.back_unpinned();
+        if (!victim)
+            victim = from_t1 ? t2_.back_unpinned() : t1_.back_unpinned();
+        return victim;
+    }
+
+    void ARCPolicy::Remove(Page *page)
+    {
+        if (page->list_hook().queue == kT1)
+        {
+            t1_.erase(page);
+            b1_.push_front(page->id());
+        }
+        else
+        {
+            t2_.erase(page);
+            b2_.push_front(page->id());
+        }
+        page->list_hook().queue = 0;
+        TrimGhosts();
+    }
+
+    void ARCPolicy::ColdPages(size_t max, std::vector<Page *> &out) const
+    {
+        // T1 超过目标值 p 时驱逐来自 T1，否则来自 T2
+        bool t1_first = static_cast<double>(t1_.size()) > target_;
+        const PageList &first = t1_first ? t1_ : t2_;
+        const PageList &second = t1_first ? t2_ : t1_;
+        size_t start = out.size();
+        first.collect_back(out, max);
+        second.collect_back(out, max - (out.size() - start));
+    }
+
+    void ARCPolicy::TrimGhosts()
+    {
+        // 不变式：|T1| + |B1| <= c，|T1| + |T2| + |B1| + |B2| <= 2c
+        size_t c = static_cast<size_t>(capacity_);
+        while (!b1_.empty() && t1_.size() + b1_.size() > c)
+            b1_.pop_back();
+        while (t1_.size() + t2_.size() + b1_.size() + b2_.size() > 2 * c)
+        {
+            if (!b2_.empty())
+                b2_.pop_back();
+            else if (!b1_.empty())
+                b1_.pop_back();
+            else
+                break;
+        }
+    }
+
+    void ARCPolicy::CollectStats(std::map<std::string, double> &stats) const
+    {
+        stats["arc_p"] += target_;
+        stats["arc_c"] += capacity_;
+        stats["arc_t1"] += static_cast<double>(t1_.size());
+        stats["arc_t2"] += static_cast<double>(t2_.size());
+    }
+
+} // namespace gaussdb::buffer
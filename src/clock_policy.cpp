@@ -0,0 +1,60 @@
+#include "gaussdb/clock_policy.h"
+
+#include <algorithm>
+
+namespace gaussdb::buffer
+{
+
+    ClockPolicy::ClockPolicy(size_t /*capacity*/) {}
+
+    void ClockPolicy::RecordAccess(Page *page)
+    {
+        page->set_referenced();
+    }
+
+    void ClockPolicy::Insert(Page *page)
+    {
+        page->clear_referenced();
+        ring_.insert_before(hand_, page);
+        if (!hand_)
+            hand_ = page;
+    }
+
+    Page *ClockPolicy::PickVictim(pageno /*incoming*/)
+    {
+        // 最多转两圈：第一圈清除访问位，第二圈仍找不到说明全部被 pin
+        for (size_t steps = 0; hand_ && steps < 2 * ring_.size(); ++steps)
+        {
+            Page *cand = hand_;
+            hand_ = Next(hand_);
+            if (cand->pin_count() != 0)
+                continue;
+            if (cand->clear_referenced())
+                continue;
+            return cand;
+        }
+        return nullptr;
+    }
+
+    void ClockPolicy::Remove(Page *page)
+    {
+        if (hand_ == page)
+            hand_ = ring_.size() > 1 ? Next(page) : nullptr;
+        ring_.erase(page);
+    }
+
+    void ClockPolicy::ColdPages(size_t max, std::vector<Page *> &out) const
+    {
+        // 指针前方的页最先被检查；访问位不在此清除
+        Page *page = hand_;
+        for (size_t i = 0; page && i < std::min(max, ring_.size()); ++i, page = Next(page))
+            out.push_back(page);
+    }
+
+    Page *ClockPolicy::Next(Page *page) const noexcept
+    {
+        Page *next = PageList::next(page);
+        return next ? next : ring_.front();
+    }
+
+} // namespace gaussdb::buffer
@@ -0,0 +1,61 @@
+#include "gaussdb/frame_arena.h"
+
+#include <sys/mman.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+namespace gaussdb::buffer
+{
+
+    FrameArena::FrameArena(size_t frame_size, size_t frame_count, bool prefault)
+        : frame_size_(frame_size), frame_count_(frame_count)
+    {
+        if (bytes() == 0)
+            return;
+
+        int flags = MAP_PRIVATE | MAP_ANONYMOUS;
+        if (!prefault)
+            flags |= MAP_NORESERVE;
+        void *addr = ::mmap(nullptr, bytes(), PROT_READ | PROT_WRITE, flags, -1, 0);
+        if (addr == MAP_FAILED)
+        {
+            throw std::runtime_error("Failed to map frame arena of " + std::to_string(bytes()) +
+                                     " bytes: " + std::strerror(errno));
+        }
+        base_ = static_cast<byte *>(addr);
+
+        // 大页帧（2M）尽量使用透明大页，降低 TLB 压力；须在预缺页之前设置，失败不影响正确性
+        if (frame_size_ >= 2 * 1024 * 1024)
+            ::madvise(base_, bytes(), MADV_HUGEPAGE);
+
+        if (prefault)
+            Prefault();
+    }
+
+    void FrameArena::Prefault()
+    {
+#ifdef MADV_POPULATE_WRITE
+        if (::madvise(base_, bytes(), MADV_POPULATE_WRITE) == 0)
+            return;
+#endif
+        // 旧内核：逐个系统页写一次触发缺页（写入 0 不改变内容）
+        const size_t step = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+        for (size_t off = 0; off < bytes(); off += step)
+            reinterpret_cast<volatile byte *>(base_)[off] = 0;
+    }
+
+    void FrameArena::Release(byte *frame) noexcept
+    {
+        ::madvise(frame, frame_size_, MADV_DONTNEED);
+    }
+
+    FrameArena::~FrameArena()
+    {
+        if (base_)
+            ::munmap(base_, bytes());
+    }
+
+} // namespace gaussdb::buffer
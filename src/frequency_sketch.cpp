@@ -0,0 +1,73 @@
+#include "gaussdb/frequency_sketch.h"
+
+#include <algorithm>
+
+namespace gaussdb::buffer
+{
+
+    static size_t NextPowerOfTwo(size_t n)
+    {
+        size_t p = 1;
+        while (p < n)
+            p <<= 1;
+        return p;
+    }
+
+    FrequencySketch::FrequencySketch(size_t expected_items)
+        : width_(NextPowerOfTwo(std::max<size_t>(16, expected_items))),
+          sample_size_(10 * width_),
+          table_(kDepth * width_ / 16, 0)
+    {
+    }
+
+    size_t FrequencySketch::Index(uint64_t key, int row) const noexcept
+    {
+        // 每行使用不同的种子做一次 64 位混洗（splitmix64 终结器）
+        static constexpr uint64_t kSeeds[kDepth] = {0x9E3779B97F4A7C15ull, 0xC2B2AE3D27D4EB4Full,
+                                                    0x165667B19E3779F9ull, 0xD6E8FEB86659FD93ull};
+        uint64_t h = (key + 1) * kSeeds[row];
+        h ^= h >> 31;
+        h *= 0xBF58476D1CE4E5B9ull;
+        h ^= h >> 29;
+        return static_cast<size_t>(row) * width_ + static_cast<size_t>(h & (width_ - 1));
+    }
+
+    void FrequencySketch::increment(uint64_t key) noexcept
+    {
+        bool added = false;
+        for (int row = 0; row < kDepth; ++row)
+        {
+            size_t idx = Index(key, row);
+            uint64_t &word = table_[idx >> 4];
+            int shift = static_cast<int>(idx & 15) * 4;
+            if (((word >> shift) & 0xF) < 15)
+            {
+                word += 1ull << shift;
+                added = true;
+            }
+        }
+        if (added && ++additions_ >= sample_size_)
+            Age();
+    }
+
+    unsigned FrequencySketch::estimate(uint64_t key) const noexcept
+    {
+        unsigned freq = 15;
+        for (int row = 0; row < kDepth; ++row)
+        {
+            size_t idx = Index(key, row);
+            int shift = static_cast<int>(idx & 15) * 4;
+            freq = std::min(freq, static_cast<unsigned>((table_[idx >> 4] >> shift) & 0xF));
+        }
+        return freq;
+    }
+
+    void FrequencySketch::Age() noexcept
+    {
+        // 所有 4 位计数器同时右移一位：先整体右移，再屏蔽掉从相邻计数器移入的最高位
+        for (auto &word : table_)
+            word = (word >> 1) & 0x7777777777777777ull;
+        additions_ /= 2;
+    }
+
+} // namespace gaussdb::buffer
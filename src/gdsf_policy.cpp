@@ -0,0 +1,83 @@
+#include "gaussdb/gdsf_policy.h"
+
+#include <algorithm>
+
+namespace gaussdb::buffer
+{
+
+    /// 代价模型：一次随机读的固定开销约等于顺序传输 64K 数据
+    static constexpr double kSeekCostBytes = 64.0 * 1024;
+    static constexpr double kUnitBytes = 8.0 * 1024;
+
+    GDSFPolicy::GDSFPolicy(size_t /*capacity*/) {}
+
+    double GDSFPolicy::ReloadCost(size_t page_size) noexcept
+    {
+        return (kSeekCostBytes + static_cast<double>(page_size)) / (kSeekCostBytes + kUnitBytes);
+    }
+
+    double GDSFPolicy::Priority(const Page *page, uint32_t frequency) const noexcept
+    {
+        double size_units = static_cast<double>(page->size()) / kUnitBytes;
+        return inflation_ + frequency * ReloadCost(page->size()) / size_units;
+    }
+
+    void GDSFPolicy::Reposition(Page *page, double priority)
+    {
+        auto &hook = page->list_hook();
+        if (hook.linked)
+            queue_.erase({hook.priority, page});
+        hook.priority = priority;
+        hook.linked = true;
+        queue_.insert({priority, page});
+    }
+
+    void GDSFPolicy::RecordAccess(Page *page)
+    {
+        auto &hook = page->list_hook();
+        ++hook.frequency;
+        Reposition(page, Priority(page, hook.frequency));
+    }
+
+    void GDSFPolicy::Insert(Page *page)
+    {
+        auto &hook = page->list_hook();
+        hook.linked = false;
+        hook.frequency = 1;
+        Reposition(page, Priority(page, hook.frequency));
+    }
+
+    Page *GDSFPolicy::PickVictim(pageno /*incoming*/)
+    {
+        for (auto &[priority, page] : queue_)
+        {
+            if (page->pin_count() == 0)
+                return page;
+        }
+        return nullptr;
+    }
+
+    void GDSFPolicy::Remove(Page *page)
+    {
+        auto &hook = page->list_hook();
+        if (!hook.linked)
+            return;
+        // 膨胀值只增不减：被驱逐页的 H 成为新进入页的基线
+        inflation_ = std::max(inflation_, hook.priority);
+        queue_.erase({hook.priority, page});
+        hook.linked = false;
+        hook.frequency = 0;
+    }
+
+    void GDSFPolicy::ColdPages(size_t max, std::vector<Page *> &out) const
+    {
+        for (auto it = queue_.begin(); it != queue_.end() && max > 0; ++it, --max)
+            out.push_back(it->second);
+    }
+
+    void GDSFPolicy::CollectStats(std::map<std::string, double> &stats) const
+    {
+        stats["gdsf_pages"] += static_cast<double>(queue_.size());
+    }
+
+} // namespace gaussdb::buffer
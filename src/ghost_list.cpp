@@ -0,0 +1,33 @@
+#include "gaussdb/ghost_list.h"
+
+namespace gaussdb::buffer
+{
+
+    void GhostList::push_front(pageno no)
+    {
+        erase(no);
+        order_.push_front(no);
+        index_[no] = order_.begin();
+        if (capacity_ != 0 && order_.size() > capacity_)
+            pop_back();
+    }
+
+    bool GhostList::erase(pageno no)
+    {
+        auto it = index_.find(no);
+        if (it == index_.end())
+            return false;
+        order_.erase(it->second);
+        index_.erase(it);
+        return true;
+    }
+
+    void GhostList::pop_back()
+    {
+        if (order_.empty())
+            return;
+        index_.erase(order_.back());
+        order_.pop_back();
+    }
+
+} // namespace gaussdb::buffer
@@ -0,0 +1,33 @@
+#include "gaussdb/io_backend.h"
+#include "gaussdb/io_uring_backend.h"
+#include "gaussdb/sync_io_backend.h"
+
+#include <iostream>
+#include <stdexcept>
+
+namespace gaussdb::buffer
+{
+
+    std::unique_ptr<IoBackend> MakeIoBackend(const std::string &name)
+    {
+        if (name == "sync")
+            return std::make_unique<SyncIoBackend>();
+        if (name == "io_uring")
+            return std::make_unique<IoUringBackend>();
+        if (name == "auto")
+        {
+            try
+            {
+                return std::make_unique<IoUringBackend>();
+            }
+            catch (const std::exception &e)
+            {
+                // 内核过旧或被 seccomp 禁用：退回阻塞 I/O
+                std::cerr << "[IoBackend] " << e.what() << ", falling back to sync I/O" << std::endl;
+                return std::make_unique<SyncIoBackend>();
+            }
+        }
+        throw std::invalid_argument("Unknown I/O backend: " + name + " (expected auto, sync or io_uring)");
+    }
+
+} // namespace gaussdb::buffer
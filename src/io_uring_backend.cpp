@@ -0,0 +1,312 @@
+#include "gaussdb/io_uring_backend.h"
+
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <cstring>
+#include <stdexcept>
+
+namespace gaussdb::buffer
+{
+
+    struct IoUringBackend::Batch
+    {
+        size_t remaining{0};
+    };
+
+    static int RingSetup(unsigned entries, io_uring_params *params)
+    {
+        return static_cast<int>(::syscall(__NR_io_uring_setup, entries, params));
+    }
+
+    /// 成功返回非负值，失败返回 -errno
+    static int RingEnter(int fd, unsigned to_submit, unsigned min_complete, unsigned flags)
+    {
+        int r = static_cast<int>(::syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, nullptr, 0));
+        return r < 0 ? -errno : r;
+    }
+
+    static int RingRegister(int fd, unsigned opcode, const void *arg, unsigned nr_args)
+    {
+        return static_cast<int>(::syscall(__NR_io_uring_register, fd, opcode, arg, nr_args));
+    }
+
+    template <typename T>
+    static T *RingField(void *ring, unsigned offset)
+    {
+        return reinterpret_cast<T *>(static_cast<char *>(ring) + offset);
+    }
+
+    IoUringBackend::IoUringBackend(unsigned entries)
+    {
+        io_uring_params params;
+        std::memset(&params, 0, sizeof(params));
+        ring_fd_ = RingSetup(entries, &params);
+        if (ring_fd_ < 0)
+            throw std::runtime_error(std::string("io_uring_setup failed: ") + std::strerror(errno));
+        // 没有 NODROP 时完成队列溢出会丢事件，提交者将永远等不到完成
+        if (!(params.features & IORING_FEAT_NODROP))
+        {
+            ::close(ring_fd_);
+            throw std::runtime_error("io_uring lacks IORING_FEAT_NODROP");
+        }
+
+        sq_ring_bytes_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        cq_ring_bytes_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        bool single_mmap = params.features & IORING_FEAT_SINGLE_MMAP;
+        if (single_mmap)
+            sq_ring_bytes_ = cq_ring_bytes_ = std::max(sq_ring_bytes_, cq_ring_bytes_);
+        sqes_bytes_ = params.sq_entries * sizeof(io_uring_sqe);
+
+        sq_ring_ = ::mmap(nullptr, sq_ring_bytes_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                          ring_fd_, IORING_OFF_SQ_RING);
+        cq_ring_ = single_mmap ? sq_ring_
+                               : ::mmap(nullptr, cq_ring_bytes_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                                        ring_fd_, IORING_OFF_CQ_RING);
+        void *sqes = ::mmap(nullptr, sqes_bytes_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                            ring_fd_, IORING_OFF_SQES);
+        if (sq_ring_ == MAP_FAILED || cq_ring_ == MAP_FAILED || sqes == MAP_FAILED)
+        {
+            if (sqes != MAP_FAILED)
+                ::munmap(sqes, sqes_bytes_);
+            if (cq_ring_ != MAP_FAILED && cq_ring_ != sq_ring_)
+                ::munmap(cq_ring_, cq_ring_bytes_);
+            if (sq_ring_ != MAP_FAILED)
+                ::munmap(sq_ring_, sq_ring_bytes_);
+            ::close(ring_fd_);
+            throw std::runtime_error("Failed to map io_uring rings");
+        }
+        sqes_ = static_cast<io_uring_sqe *>(sqes);
+
+        sq_head_ = RingField<unsigned>(sq_ring_, params.sq_off.head);
+        sq_tail_ = RingField<unsigned>(sq_ring_, params.sq_off.tail);
+        sq_mask_ = *RingField<unsigned>(sq_ring_, params.sq_off.ring_mask);
+        sq_entries_ = params.sq_entries;
+        // SQE 槽位与提交数组一一对应，之后只需推进 tail
+        unsigned *array = RingField<unsigned>(sq_ring_, params.sq_off.array);
+        for (unsigned i = 0; i < sq_entries_; ++i)
+            array[i] = i;
+
+        cq_head_ = RingField<unsigned>(cq_ring_, params.cq_off.head);
+        cq_tail_ = RingField<unsigned>(cq_ring_, params.cq_off.tail);
+        cq_mask_ = *RingField<unsigned>(cq_ring_, params.cq_off.ring_mask);
+        cqes_ = RingField<io_uring_cqe>(cq_ring_, params.cq_off.cqes);
+    }
+
+    IoUringBackend::~IoUringBackend()
+    {
+        ::munmap(sqes_, sqes_bytes_);
+        if (cq_ring_ != sq_ring_)
+            ::munmap(cq_ring_, cq_ring_bytes_);
+        ::munmap(sq_ring_, sq_ring_bytes_);
+        ::close(ring_fd_);
+    }
+
+    bool IoUringBackend::RegisterBuffers(const std::vector<iovec> &regions)
+    {
+        std::lock_guard<std::mutex> guard(mutex_);
+        if (!fixed_.empty() || regions.empty())
+            return false;
+        if (RingRegister(ring_fd_, IORING_REGISTER_BUFFERS, regions.data(), static_cast<unsigned>(regions.size())) < 0)
+            return false;
+        fixed_ = regions;
+        return true;
+    }
+
+    void IoUringBackend::Submit(IoRequest *reqs, size_t count)
+    {
+        if (count == 0)
+            return;
+        Batch batch{count};
+        std::vector<Pending> pending(count);
+
+        std::unique_lock<std::mutex> lock(mutex_);
+        for (size_t i = 0; i < count; ++i)
+            reqs[i].ok = false;
+        if (broken_)
+            return;
+        for (size_t i = 0; i < count; ++i)
+        {
+            pending[i] = {&reqs[i], &batch, 0, reqs[i].offset};
+            Queue(&pending[i]);
+        }
+        Flush();
+
+        // ring 失效后不再收割：仍在内核中的请求可能稍后才写入完成事件，其 user_data 指向已返回的栈上进度
+        while (batch.remaining > 0 && !broken_)
+        {
+            if (Reap() > 0)
+            {
+                Flush();
+                done_cv_.notify_all();
+                continue;
+            }
+            if (reaping_)
+            {
+                done_cv_.wait(lock);
+                continue;
+            }
+            // 由本线程在内核中等待：其他提交者在 done_cv_ 上等本线程分发完成事件
+            reaping_ = true;
+            lock.unlock();
+            int r = RingEnter(ring_fd_, 0, 1, IORING_ENTER_GETEVENTS);
+            lock.lock();
+            reaping_ = false;
+            if (r < 0 && r != -EINTR && r != -EAGAIN && r != -EBUSY)
+            {
+                // 无法再等待完成事件：本批与其他提交者尚未完成的请求都按失败返回
+                broken_ = true;
+                done_cv_.notify_all();
+                break;
+            }
+            Reap();
+            Flush();
+            done_cv_.notify_all();
+        }
+    }
+
+    void IoUringBackend::Queue(Pending *p)
+    {
+        // 提交队列满：先把已有的 SQE 交给内核（内核在 enter 中同步取走 SQE）
+        if (*sq_tail_ - __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE) >= sq_entries_)
+            Flush();
+
+        IoRequest &req = *p->req;
+        unsigned tail = *sq_tail_;
+        io_uring_sqe *sqe = &sqes_[tail & sq_mask_];
+        std::memset(sqe, 0, sizeof(*sqe));
+        sqe->fd = req.fd;
+        sqe->off = static_cast<__u64>(p->offset);
+        sqe->user_data = reinterpret_cast<__u64>(p);
+        int fixed = req.iov.size() - p->first == 1 ? FixedIndex(req.iov[p->first]) : -1;
+        if (fixed >= 0)
+        {
+            sqe->opcode = req.write ? IORING_OP_WRITE_FIXED : IORING_OP_READ_FIXED;
+            sqe->addr = reinterpret_cast<__u64>(req.iov[p->first].iov_base);
+            sqe->len = static_cast<__u32>(req.iov[p->first].iov_len);
+            sqe->buf_index = static_cast<__u16>(fixed);
+        }
+        else
+        {
+            sqe->opcode = req.write ? IORING_OP_WRITEV : IORING_OP_READV;
+            sqe->addr = reinterpret_cast<__u64>(req.iov.data() + p->first);
+            sqe->len = static_cast<__u32>(std::min<size_t>(req.iov.size() - p->first, IOV_MAX));
+        }
+        __atomic_store_n(sq_tail_, tail + 1, __ATOMIC_RELEASE);
+        ++unsubmitted_;
+    }
+
+    void IoUringBackend::Flush()
+    {
+        while (unsubmitted_ > 0)
+        {
+            int r = RingEnter(ring_fd_, unsubmitted_, 0, 0);
+            if (r > 0)
+            {
+                unsubmitted_ -= std::min<unsigned>(static_cast<unsigned>(r), unsubmitted_);
+                continue;
+            }
+            if (r == -EINTR)
+                continue;
+            if (r != 0 && r != -EAGAIN && r != -EBUSY)
+            {
+                FailUnsubmitted(r);
+                return;
+            }
+            // 内核暂时无法接收（资源不足或完成队列积压）：收割一批后重试，没有可收割的就等一个完成事件
+            if (Reap() == 0)
+            {
+                RingEnter(ring_fd_, 0, 1, IORING_ENTER_GETEVENTS);
+                Reap();
+            }
+        }
+    }
+
+    void IoUringBackend::FailUnsubmitted(int res)
+    {
+        // 内核拒绝接收：从提交队列尾部收回尚未交出的 SQE（内核只在 enter 提交时读取 tail），对应请求按失败完成
+        std::vector<Pending *> failed;
+        unsigned tail = *sq_tail_;
+        for (unsigned i = tail - unsubmitted_; i != tail; ++i)
+            failed.push_back(reinterpret_cast<Pending *>(sqes_[i & sq_mask_].user_data));
+        __atomic_store_n(sq_tail_, tail - unsubmitted_, __ATOMIC_RELEASE);
+        unsubmitted_ = 0;
+        for (Pending *p : failed)
+            Complete(p, res);
+        done_cv_.notify_all();
+    }
+
+    size_t IoUringBackend::Reap()
+    {
+        // 先取出全部事件并推进 head，再逐个处理：处理中可能续提交并递归进入 Reap
+        std::vector<std::pair<Pending *, int>> events;
+        unsigned head = *cq_head_;
+        unsigned tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+        for (; head != tail; ++head)
+        {
+            const io_uring_cqe &cqe = cqes_[head & cq_mask_];
+            events.emplace_back(reinterpret_cast<Pending *>(cqe.user_data), cqe.res);
+        }
+        __atomic_store_n(cq_head_, head, __ATOMIC_RELEASE);
+        for (auto &[p, res] : events)
+            Complete(p, res);
+        return events.size();
+    }
+
+    void IoUringBackend::Complete(Pending *p, int res)
+    {
+        IoRequest &req = *p->req;
+        if (res == -EINTR || res == -EAGAIN)
+        {
+            Queue(p);
+            return;
+        }
+        if (res < 0 || (res == 0 && req.write))
+        {
+            --p->batch->remaining;
+            return;
+        }
+        if (res == 0)
+        {
+            // 读到文件末尾：剩余部分补零
+            for (; p->first < req.iov.size(); ++p->first)
+                std::memset(req.iov[p->first].iov_base, 0, req.iov[p->first].iov_len);
+        }
+        p->offset += res;
+        size_t left = static_cast<size_t>(res);
+        auto &iov = req.iov;
+        while (p->first < iov.size() && left >= iov[p->first].iov_len)
+            left -= iov[p->first++].iov_len;
+        if (left > 0)
+        {
+            iov[p->first].iov_base = static_cast<char *>(iov[p->first].iov_base) + left;
+            iov[p->first].iov_len -= left;
+        }
+        if (p->first < iov.size())
+        {
+            // 部分读写：从断点续提交
+            Queue(p);
+            return;
+        }
+        req.ok = true;
+        --p->batch->remaining;
+    }
+
+    int IoUringBackend::FixedIndex(const iovec &iov) const noexcept
+    {
+        auto *addr = static_cast<const char *>(iov.iov_base);
+        for (size_t i = 0; i < fixed_.size(); ++i)
+        {
+            auto *base = static_cast<const char *>(fixed_[i].iov_base);
+            if (addr >= base && addr + iov.iov_len <= base + fixed_[i].iov_len)
+                return static_cast<int>(i);
+        }
+        return -1;
+    }
+
+} // namespace gaussdb::buffer
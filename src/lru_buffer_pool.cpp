@@ -1,42 +1,279 @@
 #include "gaussdb/lru_buffer_pool.h"
 #include <iostream>
 #include <cstring>
+#include <algorithm>
+#include <stdexcept>
+#include <thread>
 #include <sys/stat.h>
+#include <sys/uio.h>
+#include <climits>
+#include <cerrno>
+#include <cstdlib>
 
 namespace gaussdb::buffer
 {
 
-    LRUBufferPool::LRUBufferPool(std::string file_name, const std::map<size_t, size_t> &page_no_info)
+    /// 驱逐时最多跳过的脏候选页数
+    static constexpr size_t kMaxDirtySkips = 8;
+    /// 一次缺页最多容忍的驱逐写回失败次数，超过即放弃该缺页
+    static constexpr size_t kMaxFlushFailures = 4;
+
+    /// 顺序读检测的槽位数（按 t_idx 取模）
+    static constexpr size_t kReadaheadStreams = 64;
+    /// 连续顺序读达到该次数才视为顺序流
+    static constexpr size_t kSequentialThreshold = 2;
+    /// 预读队列上限：磁盘跟不上时丢弃新的预读请求
+    static constexpr size_t kMaxQueuedReadahead = 64;
+
+    /// 一次提交给 I/O 后端的合并写段数上限：段内页在写完前持有共享锁，批次过大会拖慢前台写
+    static constexpr size_t kMaxWriteRunsPerBatch = 32;
+    /// 注册固定缓冲区时单段的字节上限（内核对单个固定缓冲区有 1GB 限制）
+    static constexpr size_t kMaxFixedBufferBytes = size_t(1) << 30;
+    /// O_DIRECT 要求的缓冲区地址、文件偏移与长度对齐（不小于常见设备的逻辑块大小）
+    static constexpr size_t kDirectIoAlignment = 4096;
+
+    /// 以 O_DIRECT 打开的 fd 能否实际读写：部分文件系统允许打开却在 I/O 时返回 EINVAL
+    static bool DirectIoUsable(int fd)
+    {
+        // 文件长度不对齐时，读到末尾的短读会让续读落在未对齐的偏移上
+        struct stat st;
+        if (::fstat(fd, &st) != 0 || st.st_size % static_cast<off_t>(kDirectIoAlignment) != 0)
+            return false;
+        void *probe = std::aligned_alloc(kDirectIoAlignment, kDirectIoAlignment);
+        if (!probe)
+            return false;
+        ssize_t r;
+        do
+            r = ::pread(fd, probe, kDirectIoAlignment, 0);
+        while (r == -1 && errno == EINTR);
+        std::free(probe);
+        return r >= 0;
+    }
+
+    LRUBufferPool::LRUBufferPool(std::string file_name, const std::map<size_t, size_t> &page_no_info,
+                                 const LRUBufferPoolOptions &options)
         : BufferPool(std::move(file_name), page_no_info)
     {
 
-        // 取第一个配置项作为 page_size
-        if (!page_no_info_.empty())
+        // 按页大小从小到大编号：{{8K, n0}, {16K, n1}} -> 8K [0, n0)、16K [n0, n0 + n1)
+        size_t total_bytes = 0;
+        pageno next_no = 0;
+        for (auto &[psize, pcount] : page_no_info_)
         {
-            page_size_ = page_no_info_.begin()->first;
-            capacity_ = page_no_info_.begin()->second;
+            SizeClass cls;
+            cls.page_size = psize;
+            cls.first_no = next_no;
+            cls.page_count = pcount;
+            cls.file_offset = static_cast<off_t>(total_bytes);
+            classes_.push_back(cls);
+            next_no += static_cast<pageno>(pcount);
+            total_bytes += psize * pcount;
         }
 
-        // 打开文件
-        fd_ = ::open(file_name_.c_str(), O_RDWR | O_CREAT, 0666);
+        // 数据文件整体放得下则全部缓存，否则划分内存预算：
+        //  - 默认按各类数据量比例把预算固定分给各页大小；
+        //  - 共享预算时每类最多可占满整个预算，实际占用按字节计，驱逐可跨页大小进行
+        shared_budget_ = options.shared_class_budget && total_bytes > options.memory_budget;
+        size_t total_frames = 0;
+        for (auto &cls : classes_)
+        {
+            if (total_bytes <= options.memory_budget)
+            {
+                cls.capacity = cls.page_count;
+            }
+            else if (shared_budget_)
+            {
+                cls.capacity = std::min(cls.page_count, std::max<size_t>(1, options.memory_budget / cls.page_size));
+            }
+            else
+            {
+                double share = static_cast<double>(options.memory_budget) * (cls.page_size * cls.page_count) / total_bytes;
+                cls.capacity = std::min(cls.page_count, std::max<size_t>(1, static_cast<size_t>(share) / cls.page_size));
+            }
+            total_frames += cls.capacity;
+        }
+
+        // 分片数不超过总帧数；共享预算时还要让每个分片的预算放得下一个最大的页
+        size_t shard_count = std::min(options.shard_count, total_frames);
+        if (shared_budget_)
+            shard_count = std::min(shard_count, options.memory_budget / classes_.back().page_size);
+        shard_count = std::max<size_t>(1, shard_count);
+        shards_.reserve(shard_count);
+        for (size_t i = 0; i < shard_count; ++i)
+        {
+            auto shard = std::make_unique<Shard>();
+            shard->classes = std::vector<ClassFrames>(classes_.size());
+            // 共享预算：预算小于最大页时仍至少放得下一页，否则该页永远无法载入
+            if (shared_budget_)
+                shard->budget_bytes = std::max(options.memory_budget / shard_count, classes_.back().page_size);
+
+            size_t shard_frames = 0;
+            for (size_t c = 0; c < classes_.size(); ++c)
+            {
+                // 页号按取模分布，连续页轮流落入各分片；余数分给前几个分片。
+                // 帧数不超过落入该分片的页数（可以为 0）；有页落入的分片每类至少一帧，帧数少于分片数时会略超预算。
+                // 共享预算时每类的帧数只受分片字节预算与落入该分片的页数限制
+                auto pages_below = [&](size_t end)
+                { return end / shard_count + (end % shard_count > i ? 1 : 0); };
+                size_t first = classes_[c].first_no;
+                size_t pages = pages_below(first + classes_[c].page_count) - pages_below(first);
+                size_t cap = classes_[c].capacity / shard_count + (i < classes_[c].capacity % shard_count ? 1 : 0);
+                if (shared_budget_)
+                    cap = shard->budget_bytes / classes_[c].page_size;
+                shard->classes[c].capacity = pages == 0 ? 0 : std::min(pages, std::max<size_t>(1, cap));
+                shard_frames += shard->classes[c].capacity;
+            }
+
+            if (shared_budget_)
+            {
+                // 分片内所有页大小共用一个策略实例，才能在不同页大小之间比较驱逐对象
+                shard->policies.push_back(MakeReplacementPolicy(options.replacement_policy, shard_frames));
+                for (auto &frames : shard->classes)
+                    frames.policy = shard->policies.front().get();
+            }
+            else
+            {
+                for (auto &frames : shard->classes)
+                {
+                    shard->policies.push_back(MakeReplacementPolicy(options.replacement_policy, frames.capacity));
+                    frames.policy = shard->policies.back().get();
+                }
+            }
+            shards_.push_back(std::move(shard));
+        }
+
+        // 每种页大小一段连续帧内存，按分片切分后构造帧描述符，全部放入空闲链表。
+        // 共享预算时帧总数超过预算，只保留地址空间、按需提交物理内存，不能预先缺页
+        for (size_t c = 0; c < classes_.size(); ++c)
+        {
+            size_t frame_count = 0;
+            for (auto &shard : shards_)
+                frame_count += shard->classes[c].capacity;
+            classes_[c].capacity = frame_count;
+            arenas_.push_back(std::make_unique<FrameArena>(classes_[c].page_size, frame_count,
+                                                           options.prefault_frames && !shared_budget_));
+
+            size_t next_frame = 0;
+            for (auto &shard : shards_)
+            {
+                ClassFrames &frames = shard->classes[c];
+                frames.frames.reserve(frames.capacity);
+                frames.free_frames.reserve(frames.capacity);
+                for (size_t k = 0; k < frames.capacity; ++k)
+                {
+                    auto page = std::make_shared<Page>(0, classes_[c].page_size, arenas_[c]->frame(next_frame++));
+                    page->set_dirty_counter(&shard->dirty_pages);
+                    frames.free_frames.push_back(page.get());
+                    frames.frames.push_back(std::move(page));
+                }
+            }
+        }
+
+        // 打开文件。O_DIRECT 绕过内核页缓存，缓冲池成为唯一的缓存：帧来自按系统页对齐的帧内存，
+        // 页大小都是对齐单位的整数倍时文件偏移与长度也天然对齐；文件系统不支持时退回普通 I/O
+        if (options.direct_io)
+        {
+            bool aligned = std::all_of(classes_.begin(), classes_.end(), [](const SizeClass &cls)
+                                       { return cls.page_size % kDirectIoAlignment == 0; });
+            if (aligned)
+                fd_ = ::open(file_name_.c_str(), O_RDWR | O_CREAT | O_DIRECT, 0666);
+            if (fd_ >= 0 && DirectIoUsable(fd_))
+            {
+                direct_io_ = true;
+            }
+            else
+            {
+                if (fd_ >= 0)
+                    ::close(fd_);
+                fd_ = -1;
+                std::cerr << "[LRUBufferPool] O_DIRECT unavailable for " << file_name_
+                          << ", falling back to buffered I/O" << std::endl;
+            }
+        }
+        if (fd_ < 0)
+            fd_ = ::open(file_name_.c_str(), O_RDWR | O_CREAT, 0666);
         if (fd_ < 0)
         {
             throw std::runtime_error("Failed to open file: " + file_name_);
         }
 
-        std::cout << "[LRUBufferPool] Initialized with capacity=" << capacity_
-                  << " pages, page_size=" << page_size_ << " bytes." << std::endl;
+        // I/O 后端：帧内存已预先缺页时注册为固定缓冲区（注册会固定物理页，按需提交的帧内存不注册）
+        io_ = MakeIoBackend(options.io_backend);
+        bool fixed_buffers = false;
+        if (options.prefault_frames && !shared_budget_)
+        {
+            std::vector<iovec> regions;
+            for (auto &arena : arenas_)
+            {
+                size_t chunk = std::max<size_t>(1, kMaxFixedBufferBytes / arena->frame_size()) * arena->frame_size();
+                for (size_t off = 0; off < arena->bytes(); off += chunk)
+                    regions.push_back({arena->frame(0) + off, std::min(chunk, arena->bytes() - off)});
+            }
+            fixed_buffers = io_->RegisterBuffers(regions);
+        }
+
+        std::cout << "[LRUBufferPool] Initialized with policy=" << options.replacement_policy
+                  << " shards=" << shards_.size() << (shared_budget_ ? " shared_budget" : "")
+                  << " io=" << io_->name() << (fixed_buffers ? "(fixed buffers)" : "")
+                  << (direct_io_ ? " direct_io" : "") << ":";
+        for (auto &cls : classes_)
+        {
+            std::cout << " [page_size=" << cls.page_size << " pages=" << cls.page_count
+                      << " capacity=" << cls.capacity << "]";
+        }
+        std::cout << std::endl;
+
+        // 空闲帧水位：低水位向下取整，帧数很少的类不做预驱逐
+        for (auto &shard : shards_)
+        {
+            if (shared_budget_)
+            {
+                shard->low_free_bytes = static_cast<size_t>(options.free_frames_low_watermark * shard->budget_bytes);
+                shard->high_free_bytes = std::max(shard->low_free_bytes,
+                                                  static_cast<size_t>(options.free_frames_high_watermark * shard->budget_bytes));
+                continue;
+            }
+            for (auto &frames : shard->classes)
+            {
+                frames.low_watermark = static_cast<size_t>(options.free_frames_low_watermark * frames.capacity);
+                frames.high_watermark = std::max(frames.low_watermark,
+                                                 static_cast<size_t>(options.free_frames_high_watermark * frames.capacity));
+            }
+        }
+
+        // 后台线程（刷脏与预驱逐）：每个线程负责一部分分片
+        dirty_ratio_target_ = options.dirty_ratio_target;
+        cleaner_scan_fraction_ = options.cleaner_scan_fraction;
+        max_write_bytes_ = options.max_write_bytes;
+        cleaner_interval_ = std::chrono::milliseconds(options.cleaner_interval_ms);
+        size_t cleaner_count = std::min(options.cleaner_threads, shards_.size());
+        background_eviction_ = cleaner_count > 0 && options.free_frames_high_watermark > 0;
+        for (size_t i = 0; i < cleaner_count; ++i)
+            cleaners_.emplace_back(&LRUBufferPool::CleanerLoop, this, i, cleaner_count);
+
+        // 预读线程
+        readahead_initial_pages_ = std::max<size_t>(1, options.readahead_initial_pages);
+        readahead_max_bytes_ = options.readahead_max_bytes;
+        streams_ = std::make_unique<ReadaheadStream[]>(kReadaheadStreams);
+        for (size_t i = 0; i < options.readahead_threads; ++i)
+            readahead_threads_.emplace_back(&LRUBufferPool::ReadaheadLoop, this);
     }
 
     LRUBufferPool::~LRUBufferPool()
     {
+        StopReadahead();
+        StopCleaners();
         FlushAll();
         if (fd_ >= 0)
             ::close(fd_);
     }
 
-    void LRUBufferPool::read_page(pageno no, unsigned int page_size, void *buf, int /*t_idx*/)
+    void LRUBufferPool::read_page(pageno no, unsigned int page_size, void *buf, int t_idx)
     {
+        // 先发起后续页的预读，再读当前页，两者的 I/O 可以重叠
+        if (!readahead_threads_.empty())
+            DetectSequential(no, t_idx);
+
         auto page = GetPage(no, page_size);
         if (!page)
         {
@@ -44,114 +281,912 @@ namespace gaussdb::buffer
             return;
         }
 
-        Page::PinGuard guard(page);
+        // GetPage 返回时页面已被 pin；若仍在加载，ReadAt 会在页锁上等待
+        Page::PinGuard guard(page, std::adopt_lock);
         page->ReadAt(0, buf, page_size);
     }
 
-    void LRUBufferPool::write_page(pageno no, unsigned int page_size, void *buf, int /*t_idx*/)
+    bool LRUBufferPool::with_page_read(pageno no, unsigned int page_size, int t_idx,
+                                       const std::function<void(const void *data, size_t len)> &fn)
     {
+        if (!readahead_threads_.empty())
+            DetectSequential(no, t_idx);
+
         auto page = GetPage(no, page_size);
         if (!page)
+        {
+            std::cerr << "[LRU] Failed to get page " << no << std::endl;
+            return false;
+        }
+
+        // pin 防止帧被驱逐复用，共享锁等待读盘完成并挡住并发写，回调看到的是一致的整页
+        Page::PinGuard guard(page, std::adopt_lock);
+        std::shared_lock<std::shared_mutex> latch(page->latch());
+        if (!page->is_loaded())
+            return false;
+        fn(page->data(), page->size());
+        return true;
+    }
+
+    void LRUBufferPool::with_pages_read(const PageRequest *pages, size_t count, int t_idx,
+                                        const std::function<bool(size_t i, const void *data, size_t len)> &fn)
+    {
+        // 先为不在缓冲池的页预留占位帧，文件中连续的页合并为一个读请求，全部一次提交并行读入
+        std::vector<pageno> nos;
+        for (size_t i = 0; i < count; ++i)
+        {
+            int cls = ClassIndex(pages[i].no);
+            if (cls >= 0 && pages[i].page_size == classes_[cls].page_size)
+                nos.push_back(pages[i].no);
+        }
+        std::sort(nos.begin(), nos.end());
+        nos.erase(std::unique(nos.begin(), nos.end()), nos.end());
+
+        std::unordered_map<pageno, std::shared_ptr<Page>> loaded;
+        std::vector<std::vector<std::shared_ptr<Page>>> runs;
+        off_t run_end = -1;
+        for (pageno no : nos)
+        {
+            auto page = TryReserveFrame(no, Page::kNotPrefetched);
+            if (!page)
+                continue;
+            off_t offset = PageOffset(no);
+            if (runs.empty() || offset != run_end)
+                runs.emplace_back();
+            run_end = offset + static_cast<off_t>(page->size());
+            runs.back().push_back(page);
+            loaded.emplace(no, std::move(page));
+        }
+        ReadRuns(runs, Page::kNotPrefetched);
+
+        // 按请求顺序回调：刚读入的页仍被 pin 住，直接使用；其余页走 with_page_read，
+        // 它可能要等待空闲帧，因此开始前先放掉本批剩余的 pin，免得等待自己持有的帧
+        for (size_t i = 0; i < count; ++i)
+        {
+            bool more = true;
+            auto it = loaded.find(pages[i].no);
+            if (it != loaded.end())
+            {
+                std::shared_lock<std::shared_mutex> latch(it->second->latch());
+                more = fn(i, it->second->data(), it->second->size());
+            }
+            else
+            {
+                for (auto &[no, page] : loaded)
+                    page->unpin();
+                loaded.clear();
+                if (!with_page_read(pages[i].no, pages[i].page_size, t_idx,
+                                    [&](const void *data, size_t len)
+                                    { more = fn(i, data, len); }))
+                    more = fn(i, nullptr, 0);
+            }
+            if (!more)
+                break;
+        }
+        for (auto &[no, page] : loaded)
+            page->unpin();
+    }
+
+    void LRUBufferPool::write_page(pageno no, unsigned int page_size, void *buf, int /*t_idx*/)
+    {
+        // page_size 与页大小一致（GetPage 会检查），写入总是整页覆盖，缺页时无需读盘
+        bool blind = false;
+        auto page = GetPage(no, page_size, &blind);
+        if (!page)
         {
             std::cerr << "[LRU] Failed to get page " << no << std::endl;
             return;
         }
 
-        Page::PinGuard guard(page);
+        Page::PinGuard guard(page, std::adopt_lock);
+        if (blind)
+        {
+            // 占位页的独占锁仍由本线程持有：填充后才结束 I/O，等待者不会看到未填充的帧
+            std::memcpy(page->data(), buf, page_size);
+            page->mark_loaded();
+            page->mark_dirty();
+            page->end_io();
+            blind_writes_.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
         page->WriteAt(0, buf, page_size);
     }
 
+    bool LRUBufferPool::with_page_write(pageno no, unsigned int page_size, int /*t_idx*/,
+                                        const std::function<void(void *data, size_t len)> &fn)
+    {
+        bool blind = false;
+        auto page = GetPage(no, page_size, &blind);
+        if (!page)
+        {
+            std::cerr << "[LRU] Failed to get page " << no << std::endl;
+            return false;
+        }
+
+        // 独占锁等待读盘完成并挡住并发读写，fn 在锁内直接覆盖帧内存；
+        // 缺页时未读盘，本线程已持有占位页的独占锁，填充后结束 I/O
+        Page::PinGuard guard(page, std::adopt_lock);
+        std::unique_lock<std::shared_mutex> latch(page->latch(), std::defer_lock);
+        if (!blind)
+            latch.lock();
+        fn(page->data(), page->size());
+        page->mark_loaded();
+        page->mark_dirty();
+        if (blind)
+        {
+            page->end_io();
+            blind_writes_.fetch_add(1, std::memory_order_relaxed);
+        }
+        return true;
+    }
+
     void LRUBufferPool::show_hit_rate()
     {
-        size_t hit = hit_count_.load();
-        size_t miss = miss_count_.load();
+        size_t hit = 0;
+        size_t miss = 0;
+        for (auto &shard : shards_)
+        {
+            hit += shard->hit_count.load(std::memory_order_relaxed);
+            miss += shard->miss_count.load(std::memory_order_relaxed);
+        }
         double rate = (hit + miss == 0) ? 0.0 : (100.0 * hit / (hit + miss));
         std::cout << "[LRUBufferPool] Hit rate: " << rate << "% (" << hit << " / " << (hit + miss) << ")\n";
+
+        size_t dirty = 0;
+        size_t cleaner_flushes = 0;
+        size_t eviction_flushes = 0;
+        for (auto &shard : shards_)
+        {
+            dirty += shard->dirty_pages.load(std::memory_order_relaxed);
+            cleaner_flushes += shard->cleaner_flushes.load(std::memory_order_relaxed);
+            eviction_flushes += shard->eviction_flushes.load(std::memory_order_relaxed);
+        }
+        std::cout << "[LRUBufferPool] Dirty pages: " << dirty << ", flushed by cleaner: " << cleaner_flushes
+                  << ", flushed on eviction: " << eviction_flushes << "\n";
+
+        size_t inline_evictions = 0;
+        size_t background_evictions = 0;
+        for (auto &shard : shards_)
+        {
+            inline_evictions += shard->inline_evictions.load(std::memory_order_relaxed);
+            background_evictions += shard->background_evictions.load(std::memory_order_relaxed);
+        }
+        std::cout << "[LRUBufferPool] Evictions on miss: " << inline_evictions
+                  << ", evicted in background: " << background_evictions << "\n";
+        std::cout << "[LRUBufferPool] Readahead pages: " << readahead_pages_.load(std::memory_order_relaxed)
+                  << ", used: " << readahead_used_.load(std::memory_order_relaxed)
+                  << ", evicted unused: " << readahead_unused_.load(std::memory_order_relaxed) << "\n";
+        std::cout << "[LRUBufferPool] Prefetch hint pages: " << hinted_pages_.load(std::memory_order_relaxed)
+                  << ", used: " << hinted_used_.load(std::memory_order_relaxed)
+                  << ", evicted unused: " << hinted_unused_.load(std::memory_order_relaxed)
+                  << ", hints dropped: " << hints_dropped_.load(std::memory_order_relaxed) << "\n";
+        std::cout << "[LRUBufferPool] Blind writes (miss without disk read): "
+                  << blind_writes_.load(std::memory_order_relaxed) << "\n";
+
+        // 各页大小的策略参数（所有分片累加），例如 ARC 当前的目标值 p；共享预算时所有页大小共用一组
+        for (size_t slot = 0; slot < shards_.front()->policies.size(); ++slot)
+        {
+            std::map<std::string, double> stats;
+            for (auto &shard : shards_)
+            {
+                std::lock_guard<std::shared_mutex> guard(shard->latch);
+                shard->policies[slot]->CollectStats(stats);
+            }
+            if (stats.empty())
+                continue;
+            if (shared_budget_)
+                std::cout << "[LRUBufferPool]   shared";
+            else
+                std::cout << "[LRUBufferPool]   page_size=" << classes_[slot].page_size;
+            for (auto &[key, value] : stats)
+                std::cout << " " << key << "=" << value;
+            std::cout << "\n";
+        }
     }
 
     // =================== 内部函数 ===================
 
-    std::shared_ptr<Page> LRUBufferPool::GetPage(pageno no, unsigned int page_size)
+    std::shared_ptr<Page> LRUBufferPool::GetPage(pageno no, unsigned int page_size, bool *overwrite)
     {
-        std::lock_guard<std::mutex> guard(latch_);
+        int cls = ClassIndex(no);
+        if (cls < 0)
+        {
+            std::cerr << "[LRU] Page no out of range: " << no << std::endl;
+            return nullptr;
+        }
+        if (page_size != classes_[cls].page_size)
+        {
+            std::cerr << "[LRU] Page " << no << " requested with size " << page_size
+                      << ", expected " << classes_[cls].page_size << std::endl;
+            return nullptr;
+        }
 
-        auto it = page_table_.find(no);
-        if (it != page_table_.end())
+        Shard &shard = ShardFor(no);
+        ClassFrames &frames = shard.classes[cls];
+
+        // 命中快路径：策略只改原子访问位时，共享锁下即可完成查找、pin 与访问记录。
+        // 驱逐持有独占锁，因此共享锁下 pin 住的页不会被同时选中
+        if (frames.policy->concurrent_access())
         {
-            // 缓存命中
-            hit_count_.fetch_add(1);
-            MoveToFront(no);
-            return it->second;
+            std::shared_lock<std::shared_mutex> rlock(shard.latch);
+            auto it = shard.page_table.find(no);
+            if (it != shard.page_table.end())
+            {
+                shard.hit_count.fetch_add(1, std::memory_order_relaxed);
+                it->second->pin();
+                frames.policy->RecordAccess(it->second.get());
+                SettlePrefetch(it->second.get(), true);
+                return it->second;
+            }
         }
 
-        // 未命中 -> 加载并插入
-        miss_count_.fetch_add(1);
-        EvictIfNeeded();
+        std::unique_lock<std::shared_mutex> lock(shard.latch);
 
-        auto page = LoadPageFromDisk(no, page_size);
-        if (!page)
-            return nullptr;
+        std::vector<Page::PinGuard> unflushable;
+        for (;;)
+        {
+            auto it = shard.page_table.find(no);
+            if (it != shard.page_table.end())
+            {
+                // 缓存命中（包括其他线程正在加载的占位页）
+                shard.hit_count.fetch_add(1, std::memory_order_relaxed);
+                frames.policy->RecordAccess(it->second.get());
+                it->second->pin();
+                SettlePrefetch(it->second.get(), true);
+                return it->second;
+            }
+            // 驱逐期间可能释放过分片锁，需重新查找页表
+            Eviction result = EvictIfNeeded(shard, frames, no, lock, unflushable);
+            if (result == Eviction::kReady)
+                break;
+            if (result == Eviction::kFailed)
+            {
+                std::cerr << "[LRU] No frame for page " << no << ": " << unflushable.size()
+                          << " dirty victim(s) could not be written back" << std::endl;
+                return nullptr;
+            }
+        }
+
+        // 未命中 -> 取一个空闲帧作为"I/O 进行中"的占位页，释放分片锁后再读盘
+        shard.miss_count.fetch_add(1, std::memory_order_relaxed);
+        auto page = InstallFrame(shard, frames, no);
+        lock.unlock();
+
+        // 调用方将覆盖整页：旧内容没有用处，不读盘，由调用方填充后结束 I/O
+        if (overwrite)
+        {
+            *overwrite = true;
+            return page;
+        }
 
-        page_table_[no] = page;
-        lru_list_.push_front(no);
+        if (!LoadPageFromDisk(page))
+        {
+            // 读盘失败按全零页处理，避免等待者读到上一页残留的帧内容
+            std::cerr << "[LRU] Failed to load page " << no << ", using a zero page" << std::endl;
+            std::memset(page->data(), 0, page->size());
+            page->mark_loaded();
+        }
+        page->end_io();
         return page;
     }
 
-    std::shared_ptr<Page> LRUBufferPool::LoadPageFromDisk(pageno no, unsigned int page_size)
+    std::shared_ptr<Page> LRUBufferPool::InstallFrame(Shard &shard, ClassFrames &frames, pageno no)
     {
-        auto page = std::make_shared<Page>(no, page_size);
-        off_t offset = static_cast<off_t>(no) * static_cast<off_t>(page_size);
-        if (!page->load_from_fd(fd_, offset))
+        Page *frame = frames.free_frames.back();
+        frames.free_frames.pop_back();
+        // 空闲帧（共享预算时为空闲字节）刚跌破低水位：唤醒后台线程补充
+        bool below_watermark;
+        if (shared_budget_)
         {
-            // 如果页不存在，初始化为全零页
-            std::memset(page->data(), 0, page_size);
+            size_t free_bytes = shard.budget_bytes - shard.resident_bytes;
+            below_watermark = free_bytes >= shard.low_free_bytes && free_bytes - frame->size() < shard.low_free_bytes;
         }
+        else
+        {
+            below_watermark = frames.free_frames.size() + 1 == frames.low_watermark;
+        }
+        shard.resident_bytes += frame->size();
+        frame->reset(no);
+        auto page = frame->shared_from_this();
+        page->pin();
+        page->begin_io();
+        shard.page_table[no] = page;
+        frames.policy->Insert(frame);
+        if (below_watermark && background_eviction_)
+            WakeCleaners();
         return page;
     }
 
-    void LRUBufferPool::EvictIfNeeded()
+    int LRUBufferPool::ClassIndex(pageno no) const
     {
-        if (page_table_.size() < capacity_)
-            return;
+        for (size_t i = 0; i < classes_.size(); ++i)
+        {
+            if (no >= classes_[i].first_no && no - classes_[i].first_no < classes_[i].page_count)
+                return static_cast<int>(i);
+        }
+        return -1;
+    }
+
+    off_t LRUBufferPool::PageOffset(pageno no) const
+    {
+        const SizeClass &cls = classes_[ClassIndex(no)];
+        return cls.file_offset + static_cast<off_t>(no - cls.first_no) * static_cast<off_t>(cls.page_size);
+    }
+
+    bool LRUBufferPool::LoadPageFromDisk(const std::shared_ptr<Page> &page)
+    {
+        IoRequest req{false, fd_, PageOffset(page->id()), {{page->data(), page->size()}}};
+        if (!io_->Submit(req))
+            return false;
+        page->mark_loaded();
+        return true;
+    }
+
+    LRUBufferPool::Eviction LRUBufferPool::EvictIfNeeded(Shard &shard, ClassFrames &frames, pageno incoming,
+                                                         std::unique_lock<std::shared_mutex> &lock,
+                                                         std::vector<Page::PinGuard> &unflushable)
+    {
+        size_t need = frames.frames.front()->size();
+        if (!frames.free_frames.empty() && shard.resident_bytes + need <= shard.budget_bytes)
+            return Eviction::kReady;
 
-        // 从尾部开始找可驱逐页
-        for (auto it = lru_list_.rbegin(); it != lru_list_.rend(); ++it)
+        Page *cand = PickVictim(frames, incoming);
+        if (cand)
         {
-            auto pid = *it;
-            auto page = page_table_[pid];
-            if (page->pin_count() == 0)
+            if (cand->is_dirty())
             {
-                FlushPage(page);
-                page_table_.erase(pid);
-                lru_list_.erase(std::next(it).base());
-                return;
+                // 脏页在分片锁外刷盘：先 pin 住防止被其他线程同时选中，
+                // 刷完后由调用方重新检查（期间该页可能又被访问或写脏）
+                auto page = cand->shared_from_this();
+                page->pin();
+                lock.unlock();
+                bool flushed = FlushPage(page);
+                lock.lock();
+                if (flushed)
+                {
+                    shard.eviction_flushes.fetch_add(1, std::memory_order_relaxed);
+                    page->unpin();
+                    return Eviction::kRetry;
+                }
+                // 写回失败（磁盘错误或空间不足）：保持 pin 住，否则下一次挑选多半还是它
+                unflushable.emplace_back(std::move(page), std::adopt_lock);
+                return unflushable.size() < kMaxFlushFailures ? Eviction::kRetry : Eviction::kFailed;
             }
+
+            shard.inline_evictions.fetch_add(1, std::memory_order_relaxed);
+            EvictPage(shard, cand, &frames);
+            return Eviction::kRetry;
         }
 
-        std::cerr << "[LRU] Warning: all pages pinned, cannot evict!" << std::endl;
+        // 剩下的页里有写不回去的脏页：等下去可能永远等不到，放弃本次缺页
+        if (!unflushable.empty())
+            return Eviction::kFailed;
+        // 所有帧都被 pin：帧数固定，只能让出分片锁等待其他请求释放
+        lock.unlock();
+        std::this_thread::yield();
+        lock.lock();
+        return Eviction::kRetry;
+    }
+
+    Page *LRUBufferPool::PickVictim(ClassFrames &frames, pageno incoming)
+    {
+        // 由替换策略挑选未被 pin 的页：默认只在同一页大小中选，共享预算时可跨页大小。
+        // 有刷脏线程时，脏的候选页暂时 pin 住后重选，优先驱逐干净页，写回留给刷脏线程
+        Page *cand = frames.policy->PickVictim(incoming);
+        Page *skipped[kMaxDirtySkips];
+        size_t skip_count = 0;
+        while (cand && cand->is_dirty() && skip_count < kMaxDirtySkips && !cleaners_.empty())
+        {
+            cand->pin();
+            skipped[skip_count++] = cand;
+            cand = frames.policy->PickVictim(incoming);
+        }
+        for (size_t i = 0; i < skip_count; ++i)
+            skipped[i]->unpin();
+        if (skip_count > 0)
+        {
+            WakeCleaners();
+            if (!cand || cand->is_dirty())
+                cand = skipped[0];
+        }
+        return cand;
     }
 
-    void LRUBufferPool::MoveToFront(pageno no)
+    void LRUBufferPool::EvictPage(Shard &shard, Page *victim, const ClassFrames *keep_for)
     {
-        lru_list_.remove(no);
-        lru_list_.push_front(no);
+        int victim_cls = ClassIndex(victim->id());
+        ClassFrames &victim_frames = shard.classes[victim_cls];
+        victim_frames.policy->Remove(victim);
+        shard.page_table.erase(victim->id());
+        SettlePrefetch(victim, false);
+        victim_frames.free_frames.push_back(victim);
+        shard.resident_bytes -= victim->size();
+        // 共享预算时腾出的内存不一定由同一页大小复用，归还给内核，使物理占用与预算一致
+        if (shared_budget_ && &victim_frames != keep_for)
+            arenas_[victim_cls]->Release(victim->data());
     }
 
     bool LRUBufferPool::FlushPage(std::shared_ptr<Page> page)
     {
+        // 写盘期间持有共享锁（同 Page::flush_to_fd），否则写盘后清除 dirty 会吞掉期间发生的修改
+        std::shared_lock<std::shared_mutex> guard(page->latch());
+        if (!page->is_loaded())
+            return false;
         if (!page->is_dirty())
             return true;
-        off_t offset = static_cast<off_t>(page->id()) * static_cast<off_t>(page_size_);
-        return page->flush_to_fd(fd_, offset);
+        IoRequest req{true, fd_, PageOffset(page->id()), {{page->data(), page->size()}}};
+        if (!io_->Submit(req))
+            return false;
+        page->clear_dirty();
+        return true;
+    }
+
+    void LRUBufferPool::CleanerLoop(size_t worker, size_t stride)
+    {
+        // 相邻页号分布在不同分片：按分片划分刷脏线程时，步长整除分片数会让一个线程永远拿不到相邻的页。
+        // 因此按文件偏移划分，每个线程从所有分片收集自己那一段的脏页，再一起合并写回
+        const SizeClass &last = classes_.back();
+        off_t file_bytes = last.file_offset + static_cast<off_t>(last.page_count * last.page_size);
+        off_t begin = file_bytes / static_cast<off_t>(stride) * static_cast<off_t>(worker);
+        off_t end = worker + 1 == stride ? file_bytes : begin + file_bytes / static_cast<off_t>(stride);
+
+        std::unique_lock<std::mutex> lock(cleaner_mutex_);
+        while (!stop_cleaners_)
+        {
+            uint64_t seen = cleaner_wakeups_;
+            lock.unlock();
+            std::vector<std::shared_ptr<Page>> batch;
+            for (auto &shard : shards_)
+                CollectDirtyPages(*shard, begin, end, batch);
+            std::vector<Page *> written;
+            size_t flushed = FlushCoalesced(batch, &written);
+            for (Page *page : written)
+                ShardFor(page->id()).cleaner_flushes.fetch_add(1, std::memory_order_relaxed);
+            for (auto &page : batch)
+                page->unpin();
+            if (background_eviction_)
+            {
+                for (size_t i = worker; i < shards_.size(); i += stride)
+                    ReplenishShard(*shards_[i]);
+            }
+            lock.lock();
+            // 本轮有写回说明脏页仍在产生，立即开始下一轮；否则休眠到超时或被唤醒
+            if (flushed > 0)
+                continue;
+            cleaner_cv_.wait_for(lock, cleaner_interval_, [&]
+                                 { return stop_cleaners_ || cleaner_wakeups_ != seen; });
+        }
+    }
+
+    void LRUBufferPool::CollectDirtyPages(Shard &shard, off_t begin, off_t end,
+                                          std::vector<std::shared_ptr<Page>> &batch)
+    {
+        std::unique_lock<std::shared_mutex> lock(shard.latch);
+        size_t resident = shard.page_table.size();
+        size_t dirty = shard.dirty_pages.load(std::memory_order_relaxed);
+        if (dirty == 0)
+            return;
+
+        // 平时只看冷端（即将被驱逐的页）；脏页比例超标时扫描全部驻留页
+        bool over_target = static_cast<double>(dirty) > dirty_ratio_target_ * static_cast<double>(resident);
+        std::vector<Page *> cold;
+        for (size_t slot = 0; slot < shard.policies.size(); ++slot)
+        {
+            size_t frames = shared_budget_ ? resident : shard.classes[slot].capacity;
+            size_t depth = over_target ? frames
+                                       : std::max<size_t>(1, static_cast<size_t>(cleaner_scan_fraction_ * frames));
+            shard.policies[slot]->ColdPages(depth, cold);
+        }
+
+        // 先 pin 住再释放分片锁，防止写盘期间被驱逐；正在使用的页跳过，它们暂时不会被驱逐
+        for (Page *page : cold)
+        {
+            if (!page->is_dirty() || page->pin_count() != 0)
+                continue;
+            off_t offset = PageOffset(page->id());
+            if (offset >= begin && offset < end)
+            {
+                page->pin();
+                batch.push_back(page->shared_from_this());
+            }
+        }
+    }
+
+    size_t LRUBufferPool::ReplenishShard(Shard &shard)
+    {
+        // 只驱逐干净页：遇到脏页（或全部被 pin）即停止，脏页由下一轮刷脏写回后再驱逐
+        std::unique_lock<std::shared_mutex> lock(shard.latch);
+        size_t evicted = 0;
+        if (shared_budget_)
+        {
+            while (shard.budget_bytes - shard.resident_bytes < shard.high_free_bytes)
+            {
+                Page *victim = PickVictim(shard.classes.front(), kNoIncomingPage);
+                if (!victim || victim->is_dirty())
+                    break;
+                EvictPage(shard, victim, nullptr);
+                ++evicted;
+            }
+        }
+        else
+        {
+            for (auto &frames : shard.classes)
+            {
+                while (frames.free_frames.size() < frames.high_watermark)
+                {
+                    Page *victim = PickVictim(frames, kNoIncomingPage);
+                    if (!victim || victim->is_dirty())
+                        break;
+                    EvictPage(shard, victim, &frames);
+                    ++evicted;
+                }
+            }
+        }
+        shard.background_evictions.fetch_add(evicted, std::memory_order_relaxed);
+        return evicted;
+    }
+
+    void LRUBufferPool::WakeCleaners()
+    {
+        if (cleaners_.empty())
+            return;
+        {
+            std::lock_guard<std::mutex> guard(cleaner_mutex_);
+            ++cleaner_wakeups_;
+        }
+        cleaner_cv_.notify_all();
+    }
+
+    void LRUBufferPool::StopCleaners()
+    {
+        {
+            std::lock_guard<std::mutex> guard(cleaner_mutex_);
+            stop_cleaners_ = true;
+        }
+        cleaner_cv_.notify_all();
+        for (auto &t : cleaners_)
+            t.join();
+        cleaners_.clear();
+    }
+
+    void LRUBufferPool::DetectSequential(pageno no, int t_idx)
+    {
+        int cls = ClassIndex(no);
+        if (cls < 0)
+            return;
+        const SizeClass &sc = classes_[cls];
+        size_t max_pages = readahead_max_bytes_ / sc.page_size;
+        if (max_pages < 2)
+            return; // 大页本身就是一次大 I/O
+
+        ReadaheadStream &stream = streams_[static_cast<size_t>(t_idx) % kReadaheadStreams];
+        std::lock_guard<std::mutex> guard(stream.mutex);
+        if (no != stream.next || no == sc.first_no)
+        {
+            // 流中断（或换到另一类页）：重新开始计数
+            stream.run = 0;
+            stream.ahead = no + 1;
+            stream.window = std::min(readahead_initial_pages_, max_pages);
+        }
+        stream.next = no + 1;
+        if (++stream.run < kSequentialThreshold)
+            return;
+        // 已预读区间还剩一半以上没读到：不必发起下一段
+        if (stream.ahead > no && stream.ahead - no > stream.window / 2)
+            return;
+
+        // 按上次调整以来预读页的命中情况伸缩窗口：大部分被用到则加倍，浪费较多则减半
+        size_t used = readahead_used_.load(std::memory_order_relaxed);
+        size_t unused = readahead_unused_.load(std::memory_order_relaxed);
+        size_t du = used - stream.used_seen;
+        size_t dw = unused - stream.unused_seen;
+        if (du + dw > 0)
+        {
+            double hit = static_cast<double>(du) / static_cast<double>(du + dw);
+            if (hit >= 0.75)
+                stream.window = std::min(stream.window * 2, max_pages);
+            else if (hit < 0.5)
+                stream.window = std::max<size_t>(1, stream.window / 2);
+        }
+        stream.used_seen = used;
+        stream.unused_seen = unused;
+
+        pageno first = std::max<pageno>(stream.ahead, no + 1);
+        pageno class_end = static_cast<pageno>(sc.first_no + sc.page_count);
+        if (first >= class_end)
+            return;
+        size_t count = std::min<size_t>(stream.window, class_end - first);
+        stream.ahead = static_cast<pageno>(first + count);
+
+        {
+            std::lock_guard<std::mutex> lock(readahead_mutex_);
+            if (readahead_queue_.size() >= kMaxQueuedReadahead)
+                return;
+            readahead_queue_.push_back({&stream, first, count, {}});
+        }
+        readahead_cv_.notify_one();
+    }
+
+    void LRUBufferPool::ReadaheadLoop()
+    {
+        std::unique_lock<std::mutex> lock(readahead_mutex_);
+        for (;;)
+        {
+            readahead_cv_.wait(lock, [this]
+                               { return stop_readahead_ || !readahead_queue_.empty(); });
+            if (stop_readahead_)
+                return;
+            ReadaheadRequest req = std::move(readahead_queue_.front());
+            readahead_queue_.pop_front();
+            lock.unlock();
+            if (!req.stream)
+            {
+                Prefetch(req.hinted, Page::kHinted);
+                lock.lock();
+                continue;
+            }
+            // 请求排队期间顺序流可能已经读过了区间前部：跳过这部分，免得重新读入刚读过的页
+            pageno first = req.first;
+            {
+                std::lock_guard<std::mutex> guard(req.stream->mutex);
+                if (req.stream->next > first && req.stream->next - first < req.count)
+                    first = req.stream->next;
+                else if (req.stream->next > first)
+                    first = static_cast<pageno>(req.first + req.count);
+            }
+            if (first < req.first + req.count)
+            {
+                std::vector<pageno> nos(req.first + req.count - first);
+                for (size_t i = 0; i < nos.size(); ++i)
+                    nos[i] = static_cast<pageno>(first + i);
+                Prefetch(nos, Page::kReadahead);
+            }
+            lock.lock();
+        }
+    }
+
+    void LRUBufferPool::Prefetch(const std::vector<pageno> &nos, Page::Prefetch source)
+    {
+        // 已在缓冲池中（或无法立即预留）的页与页号间隔都会切断区间，每段一个读请求，全部一次提交
+        std::vector<std::vector<std::shared_ptr<Page>>> runs;
+        off_t run_end = -1;
+        for (pageno no : nos)
+        {
+            auto page = TryReserveFrame(no, source);
+            if (!page)
+            {
+                run_end = -1;
+                continue;
+            }
+            off_t offset = PageOffset(no);
+            if (runs.empty() || offset != run_end)
+                runs.emplace_back();
+            run_end = offset + static_cast<off_t>(page->size());
+            runs.back().push_back(std::move(page));
+        }
+        ReadRuns(runs, source);
+    }
+
+    void LRUBufferPool::prefetch_pages(const pageno *pages, size_t count, int /*t_idx*/)
+    {
+        if (readahead_threads_.empty() || count == 0)
+            return;
+        std::vector<pageno> nos;
+        nos.reserve(count);
+        for (size_t i = 0; i < count; ++i)
+        {
+            if (ClassIndex(pages[i]) >= 0)
+                nos.push_back(pages[i]);
+        }
+        std::sort(nos.begin(), nos.end());
+        nos.erase(std::unique(nos.begin(), nos.end()), nos.end());
+        if (nos.empty())
+            return;
+
+        {
+            std::lock_guard<std::mutex> lock(readahead_mutex_);
+            if (readahead_queue_.size() >= kMaxQueuedReadahead)
+            {
+                // 提示只是建议：预读线程跟不上时丢弃，不阻塞调用方
+                hints_dropped_.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+            readahead_queue_.push_back({nullptr, 0, 0, std::move(nos)});
+        }
+        readahead_cv_.notify_one();
+    }
+
+    void LRUBufferPool::SettlePrefetch(Page *page, bool used)
+    {
+        switch (page->take_prefetched())
+        {
+        case Page::kReadahead:
+            (used ? readahead_used_ : readahead_unused_).fetch_add(1, std::memory_order_relaxed);
+            break;
+        case Page::kHinted:
+            (used ? hinted_used_ : hinted_unused_).fetch_add(1, std::memory_order_relaxed);
+            break;
+        default:
+            break;
+        }
+    }
+
+    std::shared_ptr<Page> LRUBufferPool::TryReserveFrame(pageno no, Page::Prefetch source)
+    {
+        Shard &shard = ShardFor(no);
+        ClassFrames &frames = shard.classes[ClassIndex(no)];
+        std::unique_lock<std::shared_mutex> lock(shard.latch);
+        if (shard.page_table.count(no))
+            return nullptr;
+
+        // 调用方持有本批占位页的页锁，不能等待其他请求 unpin，也不同步刷脏页
+        size_t need = frames.frames.front()->size();
+        while (frames.free_frames.empty() || shard.resident_bytes + need > shard.budget_bytes)
+        {
+            Page *victim = PickVictim(frames, no);
+            if (!victim || victim->is_dirty())
+                return nullptr;
+            shard.inline_evictions.fetch_add(1, std::memory_order_relaxed);
+            EvictPage(shard, victim, &frames);
+        }
+        // 预留时就打上预读标记：读盘期间到达的请求在页锁上等待，同样算作预读命中
+        auto page = InstallFrame(shard, frames, no);
+        if (source != Page::kNotPrefetched)
+            page->set_prefetched(source);
+        else
+            shard.miss_count.fetch_add(1, std::memory_order_relaxed);
+        return page;
+    }
+
+    void LRUBufferPool::ReadRuns(std::vector<std::vector<std::shared_ptr<Page>>> &runs, Page::Prefetch source)
+    {
+        if (runs.empty())
+            return;
+
+        std::vector<IoRequest> reqs(runs.size());
+        for (size_t r = 0; r < runs.size(); ++r)
+        {
+            reqs[r].fd = fd_;
+            reqs[r].offset = PageOffset(runs[r].front()->id());
+            for (auto &page : runs[r])
+                reqs[r].iov.push_back({page->data(), page->size()});
+        }
+        io_->Submit(reqs.data(), reqs.size());
+
+        for (size_t r = 0; r < runs.size(); ++r)
+        {
+            for (auto &page : runs[r])
+            {
+                if (reqs[r].ok)
+                {
+                    page->mark_loaded();
+                }
+                else if (!LoadPageFromDisk(page))
+                {
+                    std::memset(page->data(), 0, page->size());
+                    page->mark_loaded();
+                }
+                page->end_io();
+                if (source != Page::kNotPrefetched)
+                    page->unpin();
+            }
+            if (source == Page::kReadahead)
+                readahead_pages_.fetch_add(runs[r].size(), std::memory_order_relaxed);
+            else if (source == Page::kHinted)
+                hinted_pages_.fetch_add(runs[r].size(), std::memory_order_relaxed);
+        }
+    }
+
+    void LRUBufferPool::StopReadahead()
+    {
+        {
+            std::lock_guard<std::mutex> guard(readahead_mutex_);
+            stop_readahead_ = true;
+        }
+        readahead_cv_.notify_all();
+        for (auto &t : readahead_threads_)
+            t.join();
+        readahead_threads_.clear();
+    }
+
+    size_t LRUBufferPool::FlushCoalesced(std::vector<std::shared_ptr<Page>> &pages, std::vector<Page *> *written_pages)
+    {
+        std::sort(pages.begin(), pages.end(), [this](const std::shared_ptr<Page> &a, const std::shared_ptr<Page> &b)
+                  { return PageOffset(a->id()) < PageOffset(b->id()); });
+
+        // 按文件偏移顺序逐段合并：段内每页持有共享锁直到写完，与 flush_to_fd 一样防止写盘期间被修改。
+        // 所有合并写都按偏移升序加锁，多个刷盘线程之间不会死锁。
+        // 每凑满 kMaxWriteRunsPerBatch 段一次提交给 I/O 后端，各段的写入并发进行
+        size_t written = 0;
+        std::vector<std::vector<Page *>> runs;
+        std::vector<IoRequest> reqs;
+        auto submit = [&]
+        {
+            io_->Submit(reqs.data(), reqs.size());
+            for (size_t r = 0; r < runs.size(); ++r)
+            {
+                for (Page *page : runs[r])
+                {
+                    if (reqs[r].ok)
+                        page->clear_dirty();
+                    page->latch().unlock_shared();
+                }
+                if (reqs[r].ok)
+                {
+                    written += runs[r].size();
+                    if (written_pages)
+                        written_pages->insert(written_pages->end(), runs[r].begin(), runs[r].end());
+                }
+                else
+                    std::cerr << "[LRU] Failed to write " << runs[r].size() << " pages at offset "
+                              << reqs[r].offset << std::endl;
+            }
+            runs.clear();
+            reqs.clear();
+        };
+
+        size_t i = 0;
+        while (i < pages.size())
+        {
+            std::vector<Page *> run;
+            IoRequest req;
+            req.write = true;
+            req.fd = fd_;
+            size_t bytes = 0;
+            while (i < pages.size())
+            {
+                Page *page = pages[i].get();
+                off_t offset = PageOffset(page->id());
+                if (!run.empty() && (offset != req.offset + static_cast<off_t>(bytes) ||
+                                     bytes + page->size() > max_write_bytes_ || req.iov.size() >= IOV_MAX))
+                    break;
+                ++i;
+                page->latch().lock_shared();
+                if (!page->is_loaded() || !page->is_dirty())
+                {
+                    // 已被其他线程写回：结束当前段（该页不再参与合并）
+                    page->latch().unlock_shared();
+                    if (run.empty())
+                        continue;
+                    break;
+                }
+                if (run.empty())
+                    req.offset = offset;
+                run.push_back(page);
+                req.iov.push_back({page->data(), page->size()});
+                bytes += page->size();
+            }
+            if (run.empty())
+                continue;
+            runs.push_back(std::move(run));
+            reqs.push_back(std::move(req));
+            if (runs.size() >= kMaxWriteRunsPerBatch)
+                submit();
+        }
+        if (!runs.empty())
+            submit();
+        return written;
     }
 
     void LRUBufferPool::FlushAll()
     {
-        std::lock_guard<std::mutex> guard(latch_);
-        for (auto &[pid, page] : page_table_)
+        // 先在各分片锁内 pin 住全部脏页，再在分片锁外按文件偏移合并写回
+        std::vector<std::shared_ptr<Page>> dirty;
+        for (auto &shard : shards_)
         {
-            FlushPage(page);
+            std::lock_guard<std::shared_mutex> guard(shard->latch);
+            for (auto &[pid, page] : shard->page_table)
+            {
+                if (page->is_dirty())
+                {
+                    page->pin();
+                    dirty.push_back(page);
+                }
+            }
         }
+        FlushCoalesced(dirty);
+        for (auto &page : dirty)
+            page->unpin();
     }
 
 } // namespace gaussdb::buffer
@@ -0,0 +1,64 @@
+#include "gaussdb/lru_policy.h"
+
+namespace gaussdb::buffer
+{
+
+    // =================== LRU ===================
+
+    LRUPolicy::LRUPolicy(size_t /*capacity*/) {}
+
+    void LRUPolicy::RecordAccess(Page *page)
+    {
+        lru_list_.move_to_front(page);
+    }
+
+    void LRUPolicy::Insert(Page *page)
+    {
+        lru_list_.push_front(page);
+    }
+
+    Page *LRUPolicy::PickVictim(pageno /*incoming*/)
+    {
+        return lru_list_.back_unpinned();
+    }
+
+    void LRUPolicy::Remove(Page *page)
+    {
+        lru_list_.erase(page);
+    }
+
+    void LRUPolicy::ColdPages(size_t max, std::vector<Page *> &out) const
+    {
+        lru_list_.collect_back(out, max);
+    }
+
+    // =================== FIFO ===================
+
+    FIFOPolicy::FIFOPolicy(size_t /*capacity*/) {}
+
+    void FIFOPolicy::RecordAccess(Page * /*page*/)
+    {
+        // 命中不改变进入顺序
+    }
+
+    void FIFOPolicy::Insert(Page *page)
+    {
+        fifo_list_.push_front(page);
+    }
+
+    Page *FIFOPolicy::PickVictim(pageno /*incoming*/)
+    {
+        return fifo_list_.back_unpinned();
+    }
+
+    void FIFOPolicy::Remove(Page *page)
+    {
+        fifo_list_.erase(page);
+    }
+
+    void FIFOPolicy::ColdPages(size_t max, std::vector<Page *> &out) const
+    {
+        fifo_list_.collect_back(out, max);
+    }
+
+} // namespace gaussdb::buffer
@@ -6,6 +6,7 @@
 #include <stdexcept>
 #include <sstream>
 #include <cerrno>
+#include <mutex>
 
 namespace gaussdb::buffer
 {
@@ -13,7 +14,8 @@ namespace gaussdb::buffer
     Page::Page(page_id_t id, size_t page_size, FlushCallback flush_cb)
         : page_id_(id),
           page_size_(page_size),
-          data_(new byte[page_size]()), // 初始化分配页缓冲区并清零
+          owned_data_(new byte[page_size]()), // 初始化分配页缓冲区并清零
+          data_(owned_data_.get()),
           pin_count_(0),
           dirty_(false),
           loaded_(false),
@@ -23,6 +25,24 @@ namespace gaussdb::buffer
         // 构造后 loaded_ = false：表示尚未从磁盘加载
     }
 
+    Page::Page(page_id_t id, size_t page_size, byte *frame)
+        : page_id_(id),
+          page_size_(page_size),
+          owned_data_(frame ? nullptr : new byte[page_size]()),
+          data_(frame ? frame : owned_data_.get())
+    {
+        // 帧内存由缓冲池持有，内容在加载时整体覆盖，无需清零
+    }
+
+    void Page::reset(page_id_t id) noexcept
+    {
+        page_id_ = id;
+        update_dirty(false);
+        loaded_.store(false, std::memory_order_relaxed);
+        prefetched_.store(kNotPrefetched, std::memory_order_relaxed);
+        lsn_ = 0;
+    }
+
     Page::~Page()
     {
         // 不自动 flush，由 BufferPool 控制刷盘策略
@@ -65,7 +85,7 @@ namespace gaussdb::buffer
         if (!loaded_)
             return 0; // 未加载则返回 0
         size_t to_read = std::min(len, page_size_ - offset);
-        std::memcpy(out, data_.get() + offset, to_read);
+        std::memcpy(out, data_ + offset, to_read);
         return to_read;
     }
 
@@ -80,8 +100,8 @@ namespace gaussdb::buffer
         std::unique_lock lock(latch_);
         loaded_.store(true, std::memory_order_release); // 写入后视为已加载
         size_t to_write = std::min(len, page_size_ - offset);
-        std::memcpy(data_.get() + offset, buf, to_write);
-        dirty_.store(true, std::memory_order_release);
+        std::memcpy(data_ + offset, buf, to_write);
+        update_dirty(true);
         return to_write;
     }
 
@@ -89,52 +109,32 @@ namespace gaussdb::buffer
     // I/O 操作
     // ======================
 
-    bool Page::load_from_fd(int fd, off_t file_offset)
+    void Page::begin_io()
     {
-        std::unique_lock lock(latch_);
-        if (!data_)
-            data_.reset(new byte[page_size_]());
-        size_t total = 0;
-        while (total < page_size_)
-        {
-            ssize_t r = pread(fd, data_.get() + total, page_size_ - total, file_offset + static_cast<off_t>(total));
-            if (r == -1)
-            {
-                if (errno == EINTR)
-                    continue; // 重试
-                return false; // 读取失败
-            }
-            if (r == 0)
-            {
-                // EOF：填充剩余部分为 0
-                std::memset(data_.get() + total, 0, page_size_ - total);
-                total = page_size_;
-                break;
-            }
-            total += static_cast<size_t>(r);
-        }
-        loaded_.store(true, std::memory_order_release);
-        dirty_.store(false, std::memory_order_release); // 从磁盘加载的页默认不脏
-        return true;
+        latch_.lock();
+        io_in_progress_.store(true, std::memory_order_release);
+    }
+
+    void Page::end_io()
+    {
+        io_in_progress_.store(false, std::memory_order_release);
+        latch_.unlock();
     }
 
     bool Page::flush_to_fd(int fd, off_t file_offset)
     {
-        // 使用共享锁复制数据，避免长时间独占阻塞读者
+        // 写盘期间持有共享锁：读者可并行；写者需等待，
+        // 否则写盘后清除 dirty 会吞掉期间发生的修改
         std::shared_lock readlock(latch_);
         if (!loaded_)
             return false;
         if (!dirty_)
             return true;
 
-        std::unique_ptr<byte[]> tmp(new byte[page_size_]);
-        std::memcpy(tmp.get(), data_.get(), page_size_);
-        readlock.unlock();
-
         size_t total = 0;
         while (total < page_size_)
         {
-            ssize_t w = pwrite(fd, tmp.get() + total, page_size_ - total, file_offset + static_cast<off_t>(total));
+            ssize_t w = pwrite(fd, data_ + total, page_size_ - total, file_offset + static_cast<off_t>(total));
             if (w == -1)
             {
                 if (errno == EINTR)
@@ -143,7 +143,7 @@ namespace gaussdb::buffer
             }
             total += static_cast<size_t>(w);
         }
-        dirty_.store(false, std::memory_order_release);
+        update_dirty(false);
         return true;
     }
 
@@ -154,10 +154,21 @@ namespace gaussdb::buffer
             return false;
         bool rc = flush_cb_(*this);
         if (rc)
-            dirty_.store(false, std::memory_order_release);
+            update_dirty(false);
         return rc;
     }
 
+    void Page::update_dirty(bool dirty) noexcept
+    {
+        bool was = dirty_.exchange(dirty, std::memory_order_acq_rel);
+        if (was == dirty || !dirty_counter_)
+            return;
+        if (dirty)
+            dirty_counter_->fetch_add(1, std::memory_order_relaxed);
+        else
+            dirty_counter_->fetch_sub(1, std::memory_order_relaxed);
+    }
+
     // ======================
     // 调试信息
     // ======================
@@ -169,6 +180,7 @@ namespace gaussdb::buffer
             << ", pin=" << pin_count_.load()
             << ", dirty=" << (is_dirty() ? "y" : "n")
             << ", loaded=" << (is_loaded() ? "y" : "n")
+            << ", io=" << (io_in_progress() ? "y" : "n")
             << ", lsn=" << lsn_ << "}";
         return oss.str();
     }
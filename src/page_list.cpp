@@ -0,0 +1,97 @@
+#include "gaussdb/page_list.h"
+
+namespace gaussdb::buffer
+{
+
+    void PageList::push_front(Page *page) noexcept
+    {
+        auto &hook = page->list_hook();
+        hook.prev = nullptr;
+        hook.next = head_;
+        hook.linked = true;
+        if (head_)
+            head_->list_hook().prev = page;
+        else
+            tail_ = page;
+        head_ = page;
+        ++size_;
+    }
+
+    void PageList::push_back(Page *page) noexcept
+    {
+        auto &hook = page->list_hook();
+        hook.prev = tail_;
+        hook.next = nullptr;
+        hook.linked = true;
+        if (tail_)
+            tail_->list_hook().next = page;
+        else
+            head_ = page;
+        tail_ = page;
+        ++size_;
+    }
+
+    void PageList::insert_before(Page *pos, Page *page) noexcept
+    {
+        if (!pos)
+        {
+            push_back(page);
+            return;
+        }
+        auto &hook = page->list_hook();
+        auto &pos_hook = pos->list_hook();
+        hook.prev = pos_hook.prev;
+        hook.next = pos;
+        hook.linked = true;
+        if (pos_hook.prev)
+            pos_hook.prev->list_hook().next = page;
+        else
+            head_ = page;
+        pos_hook.prev = page;
+        ++size_;
+    }
+
+    void PageList::erase(Page *page) noexcept
+    {
+        auto &hook = page->list_hook();
+        if (!hook.linked)
+            return;
+        if (hook.prev)
+            hook.prev->list_hook().next = hook.next;
+        else
+            head_ = hook.next;
+        if (hook.next)
+            hook.next->list_hook().prev = hook.prev;
+        else
+            tail_ = hook.prev;
+        hook.prev = nullptr;
+        hook.next = nullptr;
+        hook.linked = false;
+        --size_;
+    }
+
+    void PageList::move_to_front(Page *page) noexcept
+    {
+        if (head_ == page)
+            return;
+        erase(page);
+        push_front(page);
+    }
+
+    Page *PageList::back_unpinned() const noexcept
+    {
+        for (Page *cand = tail_; cand; cand = cand->list_hook().prev)
+        {
+            if (cand->pin_count() == 0)
+                return cand;
+        }
+        return nullptr;
+    }
+
+    void PageList::collect_back(std::vector<Page *> &out, size_t max) const
+    {
+        for (Page *cand = tail_; cand && max > 0; cand = cand->list_hook().prev, --max)
+            out.push_back(cand);
+    }
+
+} // namespace gaussdb::buffer
@@ -0,0 +1,38 @@
+#include "gaussdb/replacement_policy.h"
+#include "gaussdb/lru_policy.h"
+#include "gaussdb/clock_policy.h"
+#include "gaussdb/two_queue_policy.h"
+#include "gaussdb/tinylfu_policy.h"
+#include "gaussdb/arc_policy.h"
+#include "gaussdb/gdsf_policy.h"
+
+#include <stdexcept>
+
+namespace gaussdb::buffer
+{
+
+    std::vector<std::string> ReplacementPolicyNames()
+    {
+        return {"lru", "fifo", "clock", "2q", "tinylfu", "arc", "gdsf"};
+    }
+
+    std::unique_ptr<ReplacementPolicy> MakeReplacementPolicy(const std::string &name, size_t capacity)
+    {
+        if (name == "lru")
+            return std::make_unique<LRUPolicy>(capacity);
+        if (name == "fifo")
+            return std::make_unique<FIFOPolicy>(capacity);
+        if (name == "clock")
+            return std::make_unique<ClockPolicy>(capacity);
+        if (name == "2q")
+            return std::make_unique<TwoQueuePolicy>(capacity);
+        if (name == "tinylfu")
+            return std::make_unique<TinyLFUPolicy>(capacity);
+        if (name == "arc")
+            return std::make_unique<ARCPolicy>(capacity);
+        if (name == "gdsf")
+            return std::make_unique<GDSFPolicy>(capacity);
+        throw std::invalid_argument("Unknown replacement policy: " + name);
+    }
+
+} // namespace gaussdb::buffer
@@ -1,30 +1,45 @@
 // src/server.cpp
 #include "gaussdb/server.h"
 #include "gaussdb/buffer_pool.h"
+#include "gaussdb/shm_channel.h"
 
 #include <sys/types.h>
 #include <sys/socket.h>
 #include <sys/un.h>
+#include <sys/uio.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <poll.h>
+#include <fcntl.h>
 #include <unistd.h>
 #include <cerrno>
 #include <csignal>
 #include <vector>
 #include <thread>
 #include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <unordered_set>
+#include <unordered_map>
 #include <atomic>
 #include <cassert>
 #include <iostream>
 #include <cstring>
 #include <array>
+#include <algorithm>
 #include <memory>
+#include <functional>
 
 using namespace std;
 using gaussdb::buffer::BufferPool;
 using gaussdb::buffer::pageno;
+using gaussdb::buffer::PageRequest;
 
-/* Global shutdown socket/state (kept for compatibility with example.cc's signal handler) */
-static bool g_program_shutdown = false;
+/* Global shutdown state, set by Server::request_shutdown() (signal handler safe) */
+static std::atomic<bool> g_program_shutdown{false};
 static int server_socket = -1;
+/* eventfd registered in every reactor's epoll set; written once on shutdown */
+static int g_wakeup_fd = -1;
 
 /* simple logging */
 #define LOG_INFO(msg)                     \
@@ -43,11 +58,19 @@ static int server_socket = -1;
         cerr << "[DEBUG] " << msg << endl; \
     } while (0)
 
-/* Message types and header (same layout as example) */
+/*
+ * Message types and header (same layout as example). A request with kTaggedFlag set in msg_type is
+ * followed by a uint32 request id, and its reply starts with that id; in event mode tagged requests
+ * on one connection run concurrently and their replies may arrive out of order.
+ */
 enum MSG_TYPE
 {
     GET = 0,
     SET,
+    MGET, // header.page_no = entry count, followed by BatchEntry[count]; reply: total bytes + pages in order
+    MSET, // header.page_no = entry count, followed by BatchEntry[count] and the pages; reply: total bytes
+    ATTACH, // header.page_no = slot count, header.page_size = slot size; reply: region size + memfd (see shm_channel.h)
+    PREFETCH, // header.page_no = count, followed by uint32 page_no[count]; no reply, even when tagged
     INVALID_TYPE
 };
 
@@ -58,6 +81,13 @@ struct __attribute__((packed)) Header
     unsigned int page_size;
 };
 
+/* one page of an MGET/MSET request */
+struct __attribute__((packed)) BatchEntry
+{
+    unsigned int page_no;
+    unsigned int page_size;
+};
+
 namespace gaussdb::server
 {
 
@@ -67,11 +97,54 @@ namespace gaussdb::server
         sockaddr_un m_server_addr{};
         BufferPool *m_bufferpool;
         const char *m_socket_file;
+        ServerOptions m_options;
+
+        Impl(BufferPool *bp, const char *socket_file, const ServerOptions &options)
+            : m_bufferpool(bp), m_socket_file(socket_file), m_options(options) {}
 
-        Impl(BufferPool *bp, const char *socket_file) : m_bufferpool(bp), m_socket_file(socket_file) {}
+        void run_threads();
+        void run_event_loop();
     };
 
-    /* read/write loop helpers */
+    /* largest page size; per-connection buffers are allocated with this size */
+    static constexpr size_t kMaxPageSize = 2 * 1024 * 1024;
+    /* set in msg_type when a uint32 request id follows the header (pipelined requests) */
+    static constexpr unsigned char kTaggedFlag = 0x80;
+    /* tagged requests in flight per connection before the reactor stops reading from it */
+    static constexpr size_t kMaxInFlight = 64;
+    /* largest number of pages in one MGET/MSET */
+    static constexpr size_t kMaxBatchPages = 1024;
+    /* MSET payloads are received and applied in chunks of whole pages of at most this many bytes */
+    static constexpr size_t kMaxChunkBytes = 4 * kMaxPageSize;
+    /* unsent reply bytes a connection may pile up before the reactor stops reading its requests */
+    static constexpr size_t kMaxReplyBacklog = 4 * kMaxPageSize;
+    /* how often a thread-mode connection waiting on a slow client re-checks the shutdown flag */
+    static constexpr int kPollIntervalMs = 100;
+
+    /* one-byte wakeup on a shared-memory connection; never blocks (unread wakeups are enough) */
+    static bool notify_peer(int fd)
+    {
+        const char bell = 0;
+        ssize_t r = ::send(fd, &bell, 1, MSG_DONTWAIT | MSG_NOSIGNAL);
+        return r == 1 || (r == -1 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR));
+    }
+
+    /* wait until a non-blocking socket is ready; false on shutdown or a broken socket */
+    static bool wait_ready(int fd, short events)
+    {
+        pollfd pfd{fd, events, 0};
+        while (!g_program_shutdown)
+        {
+            int r = ::poll(&pfd, 1, kPollIntervalMs);
+            if (r > 0)
+                return true;
+            if (r == -1 && errno != EINTR)
+                return false;
+        }
+        return false;
+    }
+
+    /* read/write loop helpers; on non-blocking sockets they wait for readiness */
     static int read_loop(int fd, unsigned char *buf, uint count)
     {
         int ret = count;
@@ -82,6 +155,8 @@ namespace gaussdb::server
             {
                 if (errno == EINTR)
                     continue;
+                if ((errno == EAGAIN || errno == EWOULDBLOCK) && wait_ready(fd, POLLIN))
+                    continue;
                 LOG_ERROR("Package read error: " << strerror(errno));
                 return -1;
             }
@@ -96,204 +171,1654 @@ namespace gaussdb::server
         return ret;
     }
 
-    static int write_loop(int fd, unsigned char *buf, uint count)
+    /*
+     * send iovecs without waiting, advancing iov past what went out. MSG_NOSIGNAL: a client that
+     * disconnects before its reply must not kill the server with SIGPIPE. Returns 1 when everything was
+     * sent, 0 as soon as the socket is full, -1 when the connection is broken.
+     */
+    static int send_iov(int fd, iovec *&iov, int &iovcnt)
     {
-        int ret = count;
-        while (count)
+        while (iovcnt > 0)
         {
-            ssize_t sendcnt = ::write(fd, buf, count);
+            msghdr msg{};
+            msg.msg_iov = iov;
+            msg.msg_iovlen = iovcnt;
+            ssize_t sendcnt = ::sendmsg(fd, &msg, MSG_DONTWAIT | MSG_NOSIGNAL);
             if (sendcnt == -1)
             {
                 if (errno == EINTR)
                     continue;
+                if (errno == EAGAIN || errno == EWOULDBLOCK)
+                    return 0;
                 LOG_ERROR("Package write error: " << strerror(errno));
                 return -1;
             }
-            else if (sendcnt == 0)
+            while (iovcnt > 0 && static_cast<size_t>(sendcnt) >= iov->iov_len)
             {
-                LOG_INFO("Connection disconnected.");
-                return 0;
+                sendcnt -= iov->iov_len;
+                ++iov;
+                --iovcnt;
+            }
+            if (iovcnt > 0)
+            {
+                iov->iov_base = static_cast<unsigned char *>(iov->iov_base) + sendcnt;
+                iov->iov_len -= sendcnt;
             }
-            count -= sendcnt;
-            buf += sendcnt;
         }
-        return ret;
+        return 1;
     }
 
-    /* Thread worker data (managed by Server::listen_forever) */
-    struct ThreadData
+    /*
+     * The replies of one connection, in the order they go out. A reply is sent at once when nothing is
+     * queued ahead of it and the socket takes it; whatever the socket does not take is copied into a
+     * segment that drain() sends later, so whoever produces a reply never waits for the client to read.
+     * A reply produced piece by piece (MGET) is an open part: replies posted after it wait behind it.
+     * Its producer parks it instead of queuing more than one piece, and drain() hands it back once the
+     * socket has taken everything ahead of it.
+     */
+    class ReplyStream
     {
-        std::thread th;
-        BufferPool *bufferpool;
-        int client_socket;
-        int thread_index;
+    public:
+        enum Result
+        {
+            kSent,   // post: everything went out; drain: nothing is left the socket could take now
+            kQueued, // post: the rest waits in the stream; drain: the socket is full
+            kBroken, // the connection is broken
+            kResume, // drain: the head is a parked part whose producer may go on now
+        };
+        struct Segment
+        {
+            std::vector<unsigned char> bytes;
+            size_t sent = 0;     // bytes of the segment already on the socket
+            bool open = false;   // a part still being produced
+            bool parked = false; // its producer waits for drain() to reach it
+        };
 
-        ThreadData(BufferPool *bp, int socket, int t_idx)
-            : bufferpool(bp), client_socket(socket), thread_index(t_idx) {}
+        /* send one reply, queuing whatever of it the socket does not take at once */
+        Result post(int fd, iovec *iov, int iovcnt);
+        /* open a reply produced in pieces; the segment stays valid until close_part() */
+        Segment *open_part();
+        Result post_part(Segment *part, int fd, iovec *iov, int iovcnt);
+        /* the part is complete; true when the stream now has bytes the socket could take */
+        bool close_part(Segment *part);
+        /* park the part until drain() reaches it; false when it is already first in line and fully sent */
+        bool park(Segment *part);
+        /*
+         * send a reply that needs the socket to itself (it carries a descriptor): 1 when sent, 0 when other
+         * replies are queued or the socket is full and nothing was sent, -1 when the connection is broken
+         */
+        int send_alone(int fd, msghdr &msg);
+        /* send queued bytes without waiting; on kResume, parked is the part to go on with */
+        Result drain(int fd, Segment *&parked);
+        bool pending();      // anything queued, open parts included
+        bool wants_output(); // queued bytes the socket could take now
+        size_t backlog();    // queued bytes not yet sent
+
+    private:
+        void append(Segment &seg, const iovec *iov, int iovcnt);
+        bool drained_head(const Segment *seg) const;
+
+        std::mutex mutex_; // guards everything below; taken while a page latch is held, so never wait under it
+        std::deque<Segment> queue_; // a deque: open parts are referred to by address
+        size_t backlog_ = 0;
     };
 
-    /* thread handler now returns void and accepts ThreadData* */
-    static void thread_handler(ThreadData *worker_data)
+    void ReplyStream::append(Segment &seg, const iovec *iov, int iovcnt)
     {
-        auto *buffer = new unsigned char[2 * 1024 * 1024];
-        while (!g_program_shutdown)
+        for (int i = 0; i < iovcnt; ++i)
         {
-            Header header{};
-            int rr = read_loop(worker_data->client_socket, (unsigned char *)&header, sizeof(header));
-            if (rr <= 0)
-                break;
+            auto *base = static_cast<const unsigned char *>(iov[i].iov_base);
+            seg.bytes.insert(seg.bytes.end(), base, base + iov[i].iov_len);
+            backlog_ += iov[i].iov_len;
+        }
+    }
+
+    /* the part is first in line and has nothing unsent, so new bytes of it may go straight to the socket */
+    bool ReplyStream::drained_head(const Segment *seg) const
+    {
+        return &queue_.front() == seg && seg->sent == seg->bytes.size();
+    }
+
+    ReplyStream::Result ReplyStream::post(int fd, iovec *iov, int iovcnt)
+    {
+        std::lock_guard<std::mutex> guard(mutex_);
+        if (queue_.empty())
+        {
+            int r = send_iov(fd, iov, iovcnt);
+            if (r != 0)
+                return r > 0 ? kSent : kBroken;
+        }
+        queue_.emplace_back();
+        append(queue_.back(), iov, iovcnt);
+        return kQueued;
+    }
+
+    ReplyStream::Segment *ReplyStream::open_part()
+    {
+        std::lock_guard<std::mutex> guard(mutex_);
+        queue_.emplace_back();
+        queue_.back().open = true;
+        return &queue_.back();
+    }
+
+    ReplyStream::Result ReplyStream::post_part(Segment *part, int fd, iovec *iov, int iovcnt)
+    {
+        std::lock_guard<std::mutex> guard(mutex_);
+        if (drained_head(part))
+        {
+            int r = send_iov(fd, iov, iovcnt);
+            if (r != 0)
+                return r > 0 ? kSent : kBroken;
+        }
+        append(*part, iov, iovcnt);
+        return kQueued;
+    }
+
+    bool ReplyStream::close_part(Segment *part)
+    {
+        std::lock_guard<std::mutex> guard(mutex_);
+        part->open = false;
+        if (drained_head(part))
+            queue_.pop_front();
+        return !queue_.empty() && queue_.front().sent < queue_.front().bytes.size();
+    }
+
+    bool ReplyStream::park(Segment *part)
+    {
+        std::lock_guard<std::mutex> guard(mutex_);
+        if (drained_head(part))
+            return false;
+        part->parked = true;
+        return true;
+    }
+
+    int ReplyStream::send_alone(int fd, msghdr &msg)
+    {
+        std::lock_guard<std::mutex> guard(mutex_);
+        if (!queue_.empty())
+            return 0;
+        for (;;)
+        {
+            // a few bytes on an empty stream: sent whole or not at all
+            ssize_t r = ::sendmsg(fd, &msg, MSG_DONTWAIT | MSG_NOSIGNAL);
+            if (r > 0)
+                return 1;
+            if (r == -1 && errno == EINTR)
+                continue;
+            return r == -1 && (errno == EAGAIN || errno == EWOULDBLOCK) ? 0 : -1;
+        }
+    }
 
-            switch (header.msg_type)
+    ReplyStream::Result ReplyStream::drain(int fd, Segment *&parked)
+    {
+        std::lock_guard<std::mutex> guard(mutex_);
+        while (!queue_.empty())
+        {
+            Segment &head = queue_.front();
+            if (head.sent < head.bytes.size())
             {
-            case SET:
-                if (read_loop(worker_data->client_socket, buffer, header.page_size) <= 0)
-                {
-                    break;
-                }
-                worker_data->bufferpool->write_page(header.page_no, header.page_size, buffer, worker_data->thread_index);
-                if (write_loop(worker_data->client_socket,
-                               (unsigned char *)&header.page_size,
-                               sizeof(header.page_size)) <= 0)
-                {
-                }
-                break;
-            case GET:
-                worker_data->bufferpool->read_page(header.page_no, header.page_size, buffer, worker_data->thread_index);
-                if (write_loop(worker_data->client_socket,
-                               (unsigned char *)&header.page_size,
-                               sizeof(header.page_size)) <= 0)
-                {
-                }
-                if (write_loop(worker_data->client_socket, buffer, header.page_size) <= 0)
-                {
-                }
-                break;
-            default:
-                LOG_ERROR("Invalid msg type");
+                size_t left = head.bytes.size() - head.sent;
+                iovec iov{head.bytes.data() + head.sent, left};
+                iovec *rest = &iov;
+                int rest_cnt = 1;
+                int r = send_iov(fd, rest, rest_cnt);
+                if (r < 0)
+                    return kBroken;
+                size_t sent = rest_cnt > 0 ? left - rest->iov_len : left;
+                head.sent += sent;
+                backlog_ -= sent;
+                if (r == 0)
+                    return kQueued;
             }
+            if (head.open)
+            {
+                // its producer sends the rest directly now
+                head.bytes.clear();
+                head.sent = 0;
+                if (!head.parked)
+                    return kSent;
+                head.parked = false;
+                parked = &head;
+                return kResume;
+            }
+            queue_.pop_front();
         }
-        delete[] buffer;
-        LOG_DEBUG("Thread exit for socket " << worker_data->client_socket);
-        // try to close client socket if not already closed
-        ::close(worker_data->client_socket);
-        // show stats (no-op for simple pool)
-        if (worker_data->bufferpool)
-            worker_data->bufferpool->show_hit_rate();
+        return kSent;
     }
 
-    Server::Server(BufferPool *bp, const char *socket_file)
+    bool ReplyStream::pending()
     {
-        pimpl_ = new Impl(bp, socket_file);
+        std::lock_guard<std::mutex> guard(mutex_);
+        return !queue_.empty();
     }
 
-    Server::~Server()
+    bool ReplyStream::wants_output()
     {
-        delete pimpl_;
+        std::lock_guard<std::mutex> guard(mutex_);
+        return !queue_.empty() && queue_.front().sent < queue_.front().bytes.size();
     }
 
-    /* create socket and bind -- unchanged logic */
-    int Server::create_socket()
+    size_t ReplyStream::backlog()
     {
-        server_socket = socket(AF_UNIX, SOCK_STREAM, 0);
-        if (server_socket < 0)
+        std::lock_guard<std::mutex> guard(mutex_);
+        return backlog_;
+    }
+
+    /* a page is served only with its own size: any other length would desync the request/reply stream */
+    static bool valid_page(BufferPool *bp, unsigned int page_no, unsigned int page_size)
+    {
+        if (page_size != 0 && page_size <= kMaxPageSize && bp->page_size_of(page_no) == page_size)
+            return true;
+        LOG_ERROR("Invalid page " << page_no << " of " << page_size << " bytes");
+        return false;
+    }
+
+    /* copy one SET payload, already received in full, into its frame; the frame is latched only for the copy */
+    static void store_page(BufferPool *bp, unsigned int page_no, unsigned int page_size, int t_idx,
+                           const unsigned char *src)
+    {
+        bp->with_page_write(page_no, page_size, t_idx,
+                            [src](void *data, size_t len)
+                            { memcpy(data, src, len); });
+    }
+
+    /* request payload storage: grows but never shrinks, and is not zero-filled since every byte is received */
+    class PayloadBuffer
+    {
+    public:
+        unsigned char *reserve(size_t len)
         {
-            LOG_ERROR("Create server socket failed, errno = " << strerror(errno));
-            return -1;
+            if (!data_ || len > capacity_)
+            {
+                data_.reset(new unsigned char[len]);
+                capacity_ = len;
+            }
+            size_ = len;
+            return data_.get();
         }
+        const unsigned char *data() const { return data_.get(); }
+        size_t size() const { return size_; }
 
-        memset(&pimpl_->m_server_addr, 0, sizeof(pimpl_->m_server_addr));
-        strncpy(pimpl_->m_server_addr.sun_path, pimpl_->m_socket_file, sizeof(pimpl_->m_server_addr.sun_path) - 1);
-        pimpl_->m_server_addr.sun_family = AF_UNIX;
-        unlink(pimpl_->m_socket_file);
+    private:
+        std::unique_ptr<unsigned char[]> data_;
+        size_t capacity_ = 0;
+        size_t size_ = 0;
+    };
 
-        if (bind(server_socket, (struct sockaddr *)&pimpl_->m_server_addr, sizeof(pimpl_->m_server_addr)) == -1)
+    /* a request read completely off the socket; an MSET is delivered as a series of chunks */
+    struct Request
+    {
+        Header header{}; // msg_type without kTaggedFlag
+        bool tagged = false;
+        unsigned int request_id = 0;
+        std::vector<PageRequest> pages; // MGET entries, or the pages of one MSET chunk
+        std::vector<pageno> hints;      // PREFETCH page numbers
+        PayloadBuffer payload;          // SET page, or the pages of one MSET chunk back to back
+        unsigned int total = 0;         // MGET/MSET: bytes of the whole batch, as sent in the reply
+        bool last = true;               // MSET: the final chunk, which sends the reply
+        size_t next_page = 0;           // MGET: pages already posted; a parked reply goes on from here
+        ReplyStream::Segment *part = nullptr; // MGET: its reply in the connection's stream, once opened
+    };
+
+    /*
+     * Incremental request parser shared by both server modes. The caller stores the bytes next() asks for
+     * and reports them with consumed(); once that returns kReady, take() hands out the request. Lengths and
+     * page sizes are validated as soon as they are known, and an MSET is cut into chunks of whole pages, so
+     * no more than kMaxChunkBytes of payload is buffered for one request. Payloads are received into one
+     * buffer kept for the connection: whoever serves the request hands it back with recycle(), and only a
+     * payload read while another is still being served needs a buffer of its own.
+     */
+    class RequestReader
+    {
+    public:
+        enum Status
         {
-            LOG_ERROR("Bind server socket failed, errno = " << strerror(errno));
-            return -1;
+            kMore,    // more bytes are needed
+            kReady,   // take() the request
+            kInvalid, // malformed request: the connection must be closed
+        };
+
+        explicit RequestReader(BufferPool *bp) : bp_(bp) { expect(kHeader, head_, sizeof(Header)); }
+
+        /* where the next len bytes of the request go */
+        unsigned char *next(size_t &len)
+        {
+            // a payload claims the buffer only when it is about to be read, by when the previous one is usually back
+            if (!dst_)
+                dst_ = claim_payload();
+            len = want_ - got_;
+            return dst_ + got_;
         }
-        LOG_INFO("Create socket success.");
-        return 0;
+        Status consumed(size_t len);
+        Request take();
+        /* return the payload of a served request for the next one; may be called from another thread */
+        void recycle(PayloadBuffer &&payload);
+
+    private:
+        enum Stage
+        {
+            kHeader,
+            kEntries,
+            kPayload,
+        };
+
+        Status expect(Stage stage, unsigned char *dst, size_t len);
+        Status advance();
+        Status begin_body();
+        Status end_entries();
+        Status next_chunk();
+        unsigned char *claim_payload();
+
+        BufferPool *bp_;
+        Stage stage_ = kHeader;
+        unsigned char *dst_ = nullptr;
+        size_t want_ = 0;
+        size_t got_ = 0;
+        unsigned char head_[sizeof(Header) + sizeof(unsigned int)]{}; // header (+ request id)
+        std::vector<unsigned char> entries_;                          // raw entry list of a batch
+        std::vector<PageRequest> batch_;                              // MSET entries
+        size_t next_page_ = 0;                                        // first page of the next MSET chunk
+        Request req_;
+        std::mutex spare_mutex_;
+        PayloadBuffer spare_; // the connection's payload buffer while no request holds it, guarded by spare_mutex_
+    };
+
+    RequestReader::Status RequestReader::expect(Stage stage, unsigned char *dst, size_t len)
+    {
+        stage_ = stage;
+        dst_ = dst;
+        want_ = len;
+        got_ = 0;
+        return len > 0 ? kMore : advance();
     }
 
-    /* listen & accept loop -- uses std::thread for workers */
-    void Server::listen_forever()
+    RequestReader::Status RequestReader::consumed(size_t len)
     {
-        if (listen(server_socket, 1000) == -1)
+        got_ += len;
+        return got_ < want_ ? kMore : advance();
+    }
+
+    RequestReader::Status RequestReader::advance()
+    {
+        switch (stage_)
         {
-            LOG_ERROR("Listen server socket failed, errno = " << strerror(errno));
-            return;
+        case kHeader:
+            if (want_ == sizeof(Header) && (head_[0] & kTaggedFlag))
+            {
+                want_ += sizeof(unsigned int);
+                return kMore;
+            }
+            return begin_body();
+        case kEntries:
+            return end_entries();
+        default:
+            return kReady;
         }
+    }
 
-        std::vector<std::unique_ptr<ThreadData>> workers;
-        int thread_count = 0;
-
-        while (!g_program_shutdown)
+    RequestReader::Status RequestReader::begin_body()
+    {
+        Header &header = req_.header;
+        memcpy(&header, head_, sizeof(Header));
+        if (header.msg_type & kTaggedFlag)
         {
-            int client_socket = accept(server_socket, nullptr, nullptr);
-            if (client_socket == -1)
+            header.msg_type &= ~kTaggedFlag;
+            req_.tagged = true;
+            memcpy(&req_.request_id, head_ + sizeof(Header), sizeof(req_.request_id));
+        }
+        switch (header.msg_type)
+        {
+        case GET:
+            return valid_page(bp_, header.page_no, header.page_size) ? kReady : kInvalid;
+        case SET:
+            if (!valid_page(bp_, header.page_no, header.page_size))
+                return kInvalid;
+            return expect(kPayload, nullptr, header.page_size);
+        case MGET:
+        case MSET:
+        case PREFETCH:
+            if (header.page_no > kMaxBatchPages)
             {
-                if (g_program_shutdown)
-                {
-                    LOG_INFO("Accept aborted due to shutdown.");
-                }
-                else
-                {
-                    LOG_ERROR("Accept failed, errno = " << strerror(errno));
-                }
-                break;
+                LOG_ERROR("Batch of " << header.page_no << " pages exceeds the limit of " << kMaxBatchPages);
+                return kInvalid;
             }
+            entries_.resize(header.page_no * (header.msg_type == PREFETCH ? sizeof(pageno) : sizeof(BatchEntry)));
+            return expect(kEntries, entries_.data(), entries_.size());
+        default:
+            // ATTACH and unknown types carry nothing beyond the header
+            return kReady;
+        }
+    }
 
-            // create worker object and push to vector BEFORE starting thread to avoid pointer invalidation
-            auto worker = std::make_unique<ThreadData>(pimpl_->m_bufferpool, client_socket, thread_count++);
-            workers.push_back(std::move(worker));
-            ThreadData *wd = workers.back().get();
+    RequestReader::Status RequestReader::end_entries()
+    {
+        size_t count = req_.header.page_no;
+        if (req_.header.msg_type == PREFETCH)
+        {
+            req_.hints.resize(count);
+            if (count > 0)
+                memcpy(req_.hints.data(), entries_.data(), entries_.size());
+            return kReady;
+        }
+        std::vector<PageRequest> &pages = req_.header.msg_type == MGET ? req_.pages : batch_;
+        pages.clear();
+        for (size_t i = 0; i < count; ++i)
+        {
+            BatchEntry entry;
+            memcpy(&entry, entries_.data() + i * sizeof(entry), sizeof(entry));
+            if (!valid_page(bp_, entry.page_no, entry.page_size))
+                return kInvalid;
+            pages.push_back({entry.page_no, entry.page_size});
+            req_.total += entry.page_size;
+        }
+        if (req_.header.msg_type == MGET)
+            return kReady;
+        next_page_ = 0;
+        return next_chunk();
+    }
+
+    RequestReader::Status RequestReader::next_chunk()
+    {
+        // whole pages up to kMaxChunkBytes, at least one
+        size_t end = next_page_;
+        size_t bytes = 0;
+        while (end < batch_.size() && (end == next_page_ || bytes + batch_[end].page_size <= kMaxChunkBytes))
+            bytes += batch_[end++].page_size;
+        req_.pages.assign(batch_.begin() + next_page_, batch_.begin() + end);
+        req_.last = end == batch_.size();
+        next_page_ = end;
+        return expect(kPayload, nullptr, bytes);
+    }
+
+    unsigned char *RequestReader::claim_payload()
+    {
+        std::lock_guard<std::mutex> guard(spare_mutex_);
+        std::swap(req_.payload, spare_);
+        return req_.payload.reserve(want_);
+    }
+
+    void RequestReader::recycle(PayloadBuffer &&payload)
+    {
+        std::lock_guard<std::mutex> guard(spare_mutex_);
+        if (!spare_.data())
+            std::swap(spare_, payload);
+    }
+
+    Request RequestReader::take()
+    {
+        Request req = std::move(req_);
+        req_ = Request();
+        if (req.last)
+        {
+            expect(kHeader, head_, sizeof(Header));
+        }
+        else
+        {
+            // the rest of the MSET follows in further chunks under the same header
+            req_.header = req.header;
+            req_.tagged = req.tagged;
+            req_.request_id = req.request_id;
+            req_.total = req.total;
+            next_chunk();
+        }
+        return req;
+    }
+
+    /* per-request socket context, shared by both server modes */
+    struct RequestContext
+    {
+        int fd = -1;
+        int t_idx = 0;
+        unsigned char *buffer = nullptr;       // kMaxPageSize scratch area
+        bool tagged = false;                   // request carried an id; the reply is prefixed with it
+        unsigned int request_id = 0;
+        ReplyStream *stream = nullptr;         // the connection's replies, in order
+        bool replies_queued = false;           // a reply was left in the stream for the socket to take later
+        bool parked = false;                   // MGET stopped with pages left; call again once the stream is drained
+        std::unique_ptr<ShmChannel> *channel = nullptr; // where ATTACH installs the shared-memory channel
+        size_t others_in_flight = 0;           // ATTACH: other requests of the connection still running
+    };
+
+    /* iovecs of the first part of a reply (tagged replies start with the request id); returns their count */
+    static int reply_iov(RequestContext &ctx, iovec *iov, const void *head, size_t head_len, const void *body,
+                         size_t body_len)
+    {
+        int cnt = 0;
+        if (ctx.tagged)
+            iov[cnt++] = {&ctx.request_id, sizeof(ctx.request_id)};
+        iov[cnt++] = {const_cast<void *>(head), head_len};
+        if (body_len > 0)
+            iov[cnt++] = {const_cast<void *>(body), body_len};
+        return cnt;
+    }
+
+    /* note what a post left queued; false when the connection is broken */
+    static bool posted(RequestContext &ctx, ReplyStream::Result r)
+    {
+        if (r == ReplyStream::kQueued)
+            ctx.replies_queued = true;
+        return r != ReplyStream::kBroken;
+    }
+
+    /* post a whole reply to the connection's stream; false when the connection is broken */
+    static bool send_reply(RequestContext &ctx, const void *head, size_t head_len, const void *body, size_t body_len)
+    {
+        iovec iov[3];
+        int cnt = reply_iov(ctx, iov, head, head_len, body, body_len);
+        return posted(ctx, ctx.stream->post(ctx.fd, iov, cnt));
+    }
 
+    /*
+     * ATTACH: create the shared-memory region and send its size with the memfd. A failed setup replies
+     * size 0 and the connection stays on the socket protocol, and so does an ATTACH sent while other
+     * requests are in flight or earlier replies are still queued: those replies could not follow the switch.
+     * Returns false when the connection is broken.
+     */
+    static bool attach_channel(const Header &header, RequestContext &ctx)
+    {
+        std::unique_ptr<ShmChannel> channel;
+        if (ctx.others_in_flight > 0)
+        {
+            LOG_ERROR("Shared memory attach refused: " << ctx.others_in_flight << " other request(s) in flight");
+        }
+        else
+        {
             try
             {
-                wd->th = std::thread(thread_handler, wd);
-                LOG_DEBUG("Thread created for client socket " << client_socket);
+                channel = std::make_unique<ShmChannel>(header.page_no,
+                                                       std::min<unsigned int>(header.page_size, kMaxPageSize));
             }
-            catch (const std::system_error &e)
+            catch (const std::exception &e)
             {
-                LOG_ERROR("Create thread failed: " << e.what());
-                shutdown(wd->client_socket, SHUT_RDWR);
-                // remove the failed worker entry
-                workers.pop_back();
+                LOG_ERROR("Shared memory attach failed: " << e.what());
             }
         }
+        unsigned int size = channel ? static_cast<unsigned int>(channel->size()) : 0;
+        if (channel && channel->size() != size)
+        {
+            LOG_ERROR("Shared memory region of " << channel->size() << " bytes is too large");
+            channel.reset();
+            size = 0;
+        }
 
-        LOG_INFO("Start shutting down.");
-        // Shutdown and join all workers
-        for (auto &wptr : workers)
+        if (channel)
         {
-            if (!wptr)
-                continue;
-            // request socket close so threads unblock from read
-            if (wptr->client_socket > 0)
+            iovec iov{&size, sizeof(size)};
+            msghdr msg{};
+            msg.msg_iov = &iov;
+            msg.msg_iovlen = 1;
+            alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int))];
+            msg.msg_control = control;
+            msg.msg_controllen = sizeof(control);
+            cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+            cmsg->cmsg_level = SOL_SOCKET;
+            cmsg->cmsg_type = SCM_RIGHTS;
+            cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+            int memfd = channel->fd();
+            memcpy(CMSG_DATA(cmsg), &memfd, sizeof(memfd));
+            int r = ctx.stream->send_alone(ctx.fd, msg);
+            if (r < 0)
+            {
+                LOG_ERROR("Shared memory attach reply failed: " << strerror(errno));
+                return false;
+            }
+            if (r > 0)
             {
-                shutdown(wptr->client_socket, SHUT_RDWR);
+                // the client holds its own descriptor now; the mapping keeps the region alive
+                channel->CloseFd();
+                LOG_INFO("Socket " << ctx.fd << " attached a shared memory channel of " << channel->entries()
+                                   << " slots x " << channel->slot_size() << " bytes");
+                *ctx.channel = std::move(channel);
+                return true;
             }
+            LOG_ERROR("Shared memory attach refused: earlier replies are still queued for the socket");
+            size = 0;
         }
+        return send_reply(ctx, &size, sizeof(size), nullptr, 0);
+    }
 
-        // join threads
-        for (auto &wptr : workers)
+    /* serve one ring request: copy between its slot and the frame, then post the completion */
+    static bool serve_ring_request(BufferPool *bp, ShmChannel &channel, const ShmRequest &req, int fd, int t_idx)
+    {
+        int32_t result = static_cast<int32_t>(req.page_size);
+        if (req.slot >= channel.entries() || req.page_size > channel.slot_size() ||
+            !valid_page(bp, req.page_no, req.page_size))
         {
-            if (!wptr)
-                continue;
-            if (wptr->th.joinable())
+            result = -EINVAL;
+        }
+        else if (req.msg_type == GET)
+        {
+            unsigned char *slot = channel.slot(req.slot);
+            if (!bp->with_page_read(req.page_no, req.page_size, t_idx,
+                                    [slot](const void *data, size_t len)
+                                    { memcpy(slot, data, len); }))
             {
-                try
-                {
-                    wptr->th.join();
-                }
-                catch (const std::system_error &e)
-                {
-                    LOG_ERROR("Thread join error: " << e.what());
-                }
+                memset(slot, 0, req.page_size);
+                result = -EIO;
+            }
+        }
+        else if (req.msg_type == SET)
+        {
+            const unsigned char *slot = channel.slot(req.slot);
+            if (!bp->with_page_write(req.page_no, req.page_size, t_idx,
+                                     [slot](void *data, size_t len)
+                                     { memcpy(data, slot, len); }))
+                result = -EIO;
+        }
+        else
+        {
+            result = -EINVAL;
+        }
+
+        if (!channel.Post({req.user_data, result, 0}))
+        {
+            LOG_ERROR("Completion ring overflow on socket " << fd << ": client exceeded " << channel.entries()
+                                                            << " requests in flight");
+            return false;
+        }
+        return !channel.TakeWaiter() || notify_peer(fd);
+    }
+
+    /*
+     * Serve one request that has been read completely off the socket (see RequestReader), so nothing here
+     * waits for client input, nor for the client to read: replies go to the connection's stream. Returns
+     * false when the connection is broken.
+     */
+    static bool handle_request(BufferPool *bp, Request &req, RequestContext &ctx)
+    {
+        const Header &header = req.header;
+        switch (header.msg_type)
+        {
+        case SET:
+        {
+            store_page(bp, header.page_no, header.page_size, ctx.t_idx, req.payload.data());
+            return send_reply(ctx, &header.page_size, sizeof(header.page_size), nullptr, 0);
+        }
+        case MSET:
+        {
+            // pages are written blind (no disk read), so a batch needs nothing beyond per-page writes;
+            // the reply follows the last chunk
+            const unsigned char *src = req.payload.data();
+            for (auto &page : req.pages)
+            {
+                store_page(bp, page.no, page.page_size, ctx.t_idx, src);
+                src += page.page_size;
+            }
+            if (!req.last)
+                return true;
+            return send_reply(ctx, &req.total, sizeof(req.total), nullptr, 0);
+        }
+        case MGET:
+        {
+            // misses of the batch go to disk together; each page is then sent from its frame. The reply is an
+            // open part of the stream, so replies of other requests never land inside it
+            const std::vector<PageRequest> &pages = req.pages;
+            const unsigned int &total = req.total;
+            if (pages.empty())
+                return send_reply(ctx, &total, sizeof(total), nullptr, 0);
+            if (!req.part)
+                req.part = ctx.stream->open_part();
+            size_t first = req.next_page;
+            bool sent = true;
+            ctx.parked = false;
+            bp->with_pages_read(pages.data() + first, pages.size() - first, ctx.t_idx,
+                                [&](size_t k, const void *data, size_t len)
+                                {
+                                    size_t i = first + k;
+                                    if (!data)
+                                    {
+                                        len = pages[i].page_size;
+                                        memset(ctx.buffer, 0, len);
+                                        data = ctx.buffer;
+                                    }
+                                    // the total length travels with the first page
+                                    iovec iov[3];
+                                    int cnt = 1;
+                                    iov[0] = {const_cast<void *>(data), len};
+                                    if (i == 0)
+                                        cnt = reply_iov(ctx, iov, &total, sizeof(total), data, len);
+                                    ReplyStream::Result r = ctx.stream->post_part(req.part, ctx.fd, iov, cnt);
+                                    req.next_page = i + 1;
+                                    if (r == ReplyStream::kBroken)
+                                    {
+                                        sent = false;
+                                        return false;
+                                    }
+                                    // the socket is full or earlier replies are waiting: stop after this one copied
+                                    // page, releasing the pins of the rest, until the stream has sent it
+                                    ctx.parked = r == ReplyStream::kQueued && req.next_page < pages.size();
+                                    return !ctx.parked;
+                                });
+            if (!sent || ctx.parked)
+                return sent;
+            if (ctx.stream->close_part(req.part))
+                ctx.replies_queued = true;
+            return true;
+        }
+        case GET:
+        {
+            // zero-copy: the reply is written straight from the latched frame, header and page in one sendmsg.
+            // The send never waits: whatever the socket does not take is copied into the reply stream, so the
+            // page's latch is held for at most one copy of it
+            bool sent = true;
+            if (!bp->with_page_read(header.page_no, header.page_size, ctx.t_idx,
+                                    [&](const void *data, size_t len)
+                                    { sent = send_reply(ctx, &header.page_size, sizeof(header.page_size), data, len); }))
+            {
+                // the reply must still carry page_size bytes
+                memset(ctx.buffer, 0, header.page_size);
+                return send_reply(ctx, &header.page_size, sizeof(header.page_size), ctx.buffer, header.page_size);
             }
+            return sent;
         }
+        case PREFETCH:
+        {
+            // fire-and-forget hint: the pool loads the pages in the background without pinning them
+            bp->prefetch_pages(req.hints.data(), req.hints.size(), ctx.t_idx);
+            return true;
+        }
+        case ATTACH:
+        {
+            // from here on the socket carries only wakeups, so the switch must not overlap other replies
+            if (ctx.tagged || !ctx.channel)
+            {
+                LOG_ERROR("ATTACH must be sent untagged");
+                return false;
+            }
+            return attach_channel(header, ctx);
+        }
+        default:
+            LOG_ERROR("Invalid msg type");
+            return true;
+        }
+    }
+
+    // ======================
+    // thread-per-connection mode
+    // ======================
+
+    /* Thread worker data (managed by Impl::run_threads) */
+    struct ThreadData
+    {
+        std::thread th;
+        BufferPool *bufferpool;
+        int client_socket;
+        int thread_index;
+        std::atomic<bool> finished{false};
+
+        ThreadData(BufferPool *bp, int socket, int t_idx)
+            : bufferpool(bp), client_socket(socket), thread_index(t_idx) {}
+    };
+
+    /* serve a shared-memory connection in order until it breaks; the socket only carries doorbells */
+    static void serve_channel(BufferPool *bp, ShmChannel &channel, int fd, int t_idx)
+    {
+        for (;;)
+        {
+            ShmRequest req;
+            int r;
+            while ((r = channel.Pop(req)) > 0)
+            {
+                if (!serve_ring_request(bp, channel, req, fd, t_idx))
+                    return;
+            }
+            if (r < 0)
+            {
+                LOG_ERROR("Corrupted submission ring on socket " << fd);
+                return;
+            }
+            if (!channel.PrepareSleep())
+                continue;
+            if (!wait_ready(fd, POLLIN))
+                return;
+            char bells[64];
+            ssize_t n = ::recv(fd, bells, sizeof(bells), MSG_DONTWAIT);
+            if (n == 0 || (n == -1 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR))
+                return;
+        }
+    }
+
+    /* send every queued reply, waiting for the socket in between; false on shutdown or a broken socket */
+    static bool flush_replies(ReplyStream &stream, int fd)
+    {
+        for (;;)
+        {
+            ReplyStream::Segment *parked = nullptr;
+            ReplyStream::Result r = stream.drain(fd, parked);
+            if (r == ReplyStream::kSent || r == ReplyStream::kResume)
+                return true;
+            if (r == ReplyStream::kBroken || !wait_ready(fd, POLLOUT))
+                return false;
+        }
+    }
+
+    /* thread handler now returns void and accepts ThreadData* */
+    static void thread_handler(ThreadData *worker_data)
+    {
+        auto *buffer = new unsigned char[kMaxPageSize];
+        std::unique_ptr<ShmChannel> channel;
+        RequestReader reader(worker_data->bufferpool);
+        // the connection has this thread to itself, so it waits for the client only once the pins are released
+        ReplyStream stream;
+        while (!g_program_shutdown)
+        {
+            size_t len;
+            unsigned char *dst = reader.next(len);
+            if (read_loop(worker_data->client_socket, dst, len) <= 0)
+                break;
+            RequestReader::Status status = reader.consumed(len);
+            if (status == RequestReader::kInvalid)
+                break;
+            if (status == RequestReader::kMore)
+                continue;
+            // tagged requests are accepted here too, but served strictly in order
+            Request req = reader.take();
+            RequestContext ctx;
+            ctx.fd = worker_data->client_socket;
+            ctx.t_idx = worker_data->thread_index;
+            ctx.buffer = buffer;
+            ctx.channel = &channel;
+            ctx.stream = &stream;
+            ctx.tagged = req.tagged;
+            ctx.request_id = req.request_id;
+            bool ok = handle_request(worker_data->bufferpool, req, ctx);
+            // a parked MGET goes on once the socket has taken its queued page, with no pins held while waiting
+            while (ok && ctx.parked)
+                ok = flush_replies(stream, ctx.fd) && handle_request(worker_data->bufferpool, req, ctx);
+            reader.recycle(std::move(req.payload));
+            if (!ok || (ctx.replies_queued && !flush_replies(stream, ctx.fd)))
+                break;
+            if (channel)
+            {
+                serve_channel(worker_data->bufferpool, *channel, ctx.fd, ctx.t_idx);
+                break;
+            }
+        }
+        delete[] buffer;
+        LOG_DEBUG("Thread exit for socket " << worker_data->client_socket);
+        // the descriptor itself is closed when the thread is reaped, so it cannot be reused meanwhile
+        shutdown(worker_data->client_socket, SHUT_RDWR);
+        // show stats (no-op for simple pool)
+        if (worker_data->bufferpool)
+            worker_data->bufferpool->show_hit_rate();
+        worker_data->finished = true;
+    }
+
+    void Server::Impl::run_threads()
+    {
+        std::vector<std::unique_ptr<ThreadData>> workers;
+        int thread_count = 0;
+
+        while (!g_program_shutdown)
+        {
+            int client_socket = accept(server_socket, nullptr, nullptr);
+            if (client_socket == -1)
+            {
+                if (errno == EINTR && !g_program_shutdown)
+                    continue;
+                if (g_program_shutdown)
+                {
+                    LOG_INFO("Accept aborted due to shutdown.");
+                }
+                else
+                {
+                    LOG_ERROR("Accept failed, errno = " << strerror(errno));
+                }
+                break;
+            }
+
+            // reap workers whose connection has ended so the list does not grow with every client
+            for (auto &wptr : workers)
+            {
+                if (wptr->finished)
+                {
+                    wptr->th.join();
+                    ::close(wptr->client_socket);
+                    wptr.reset();
+                }
+            }
+            workers.erase(std::remove(workers.begin(), workers.end(), nullptr), workers.end());
+
+            // create worker object and push to vector BEFORE starting thread to avoid pointer invalidation
+            auto worker = std::make_unique<ThreadData>(m_bufferpool, client_socket, thread_count++);
+            workers.push_back(std::move(worker));
+            ThreadData *wd = workers.back().get();
+
+            try
+            {
+                wd->th = std::thread(thread_handler, wd);
+                LOG_DEBUG("Thread created for client socket " << client_socket);
+            }
+            catch (const std::system_error &e)
+            {
+                LOG_ERROR("Create thread failed: " << e.what());
+                ::close(wd->client_socket);
+                // remove the failed worker entry
+                workers.pop_back();
+            }
+        }
+
+        LOG_INFO("Start shutting down.");
+        // request socket close so threads unblock from read
+        for (auto &wptr : workers)
+            shutdown(wptr->client_socket, SHUT_RDWR);
+
+        // join threads
+        for (auto &wptr : workers)
+        {
+            if (wptr->th.joinable())
+            {
+                try
+                {
+                    wptr->th.join();
+                }
+                catch (const std::system_error &e)
+                {
+                    LOG_ERROR("Thread join error: " << e.what());
+                }
+            }
+            ::close(wptr->client_socket);
+        }
+    }
+
+    // ======================
+    // event mode: epoll reactors + worker pool
+    // ======================
+
+    /*
+     * A client connection in event mode. Every socket is registered with EPOLLONESHOT, and only the reactor
+     * reads from it: each request, payload included, is read without blocking and then handed to a worker,
+     * so a worker never waits on a client. An untagged request (or an MSET chunk that more chunks follow)
+     * keeps the socket disarmed until the worker has finished it; after a tagged one the reactor goes on
+     * reading, so later requests are served while it is still running and replies go out as they complete.
+     * Workers never wait on a client either: what the socket does not take is left in the connection's
+     * reply stream, and the reactor sends it on EPOLLOUT. Reading stops while that backlog is too large.
+     * An MGET whose page did not fit is parked on the connection, pins released, and the reactor hands
+     * it back to a worker once the socket has taken everything ahead of its next page.
+     * After ATTACH the socket only carries doorbells and the reactor dispatches the entries of the shared
+     * submission ring instead.
+     */
+    struct Connection
+    {
+        int fd;
+        int epfd; // epoll set of the reactor that accepted it
+        int id;   // t_idx passed to the buffer pool (keeps per-connection readahead streams)
+        RequestReader reader; // the request being read, used only by the reactor while the socket is armed
+
+        ReplyStream stream; // replies in order; the reactor sends what the socket did not take at once
+
+        std::mutex state_mutex; // guards the fields below and the epoll registration (update_events)
+        size_t in_flight = 0;    // dispatched requests not yet finished
+        bool input_held = false; // an untagged request or a non-final MSET chunk is being served
+        bool paused = false;     // input not re-armed because in_flight reached kMaxInFlight
+        bool eof = false;        // the peer closed its side: close once every request is answered and sent
+        bool attached = false;   // channel is set; the reactor may be draining replies while ATTACH sets it
+        std::unordered_map<const ReplyStream::Segment *, Request> parked; // MGETs in flight waiting for the
+                                                                         // socket, by their part of the stream
+
+        std::unique_ptr<ShmChannel> channel; // set by ATTACH
+
+        std::atomic<int> refs{1}; // the epoll registration, one per dispatched request and one while the
+                                  // reactor handles an event; at zero it is retired and freed by its reactor
+        std::atomic<bool> closed{false};
+
+        Connection(int fd_, int epfd_, int id_, BufferPool *bp) : fd(fd_), epfd(epfd_), id(id_), reader(bp) {}
+    };
+
+    /* a request read off the socket (or a shared ring entry), waiting for a worker */
+    struct Task
+    {
+        Connection *conn = nullptr;
+        Request request;
+        bool from_ring = false;
+        ShmRequest ring_request{};
+    };
+
+    class EventLoop
+    {
+    public:
+        EventLoop(BufferPool *bp, const ServerOptions &options) : bp_(bp), options_(options) {}
+
+        void run();
+
+    private:
+        void reactor_loop(int epfd);
+        void accept_all(int epfd);
+        /* one epoll event of a connection, handled under a reference of the reactor's own */
+        void on_event(Connection *conn, uint32_t events);
+        /* send queued replies as far as the socket takes them, resuming the MGET they were holding up */
+        void on_writable(Connection *conn);
+        /* read as much of the pending requests as is available, dispatching each one once it is complete */
+        void on_readable(Connection *conn);
+        /* queue the request the reader has completed; true when the reactor may go on reading */
+        bool dispatch(Connection *conn);
+        /* shared-memory connection: drain the doorbells, then hand every ring entry to the workers */
+        void on_doorbell(Connection *conn);
+        void worker_loop();
+        /* hand a stopped MGET to the connection until drain() reaches it; false when it can go on at once */
+        bool park(Connection *conn, Request &req);
+        /* queue tasks for the workers */
+        void enqueue(std::vector<Task> &tasks);
+        /* replies_queued: the request left replies for the reactor to send */
+        void finish(Connection *conn, const Task &task, bool ok, bool replies_queued);
+        /* re-arm the socket for whatever the connection waits for now, or close it once it is done */
+        void update_events(Connection *conn);
+        void close_connection(Connection *conn);
+        void release(Connection *conn);
+        /* free the retired connections of this reactor; called between two batches of epoll events */
+        void free_retired(int epfd);
+
+        BufferPool *bp_;
+        ServerOptions options_;
+        std::atomic<int> next_id_{0};
+
+        std::mutex queue_mutex_;
+        std::condition_variable queue_cv_;
+        std::deque<Task> queue_;    // guarded by queue_mutex_
+        bool stop_workers_ = false; // guarded by queue_mutex_
+
+        std::mutex conns_mutex_;
+        std::unordered_set<Connection *> conns_; // all live connections, guarded by conns_mutex_
+        std::vector<Connection *> retired_;      // released, not yet freed by their reactor, guarded by conns_mutex_
+    };
+
+    /* epoll tags for the two non-connection fds */
+    static char g_listen_tag;
+    static char g_wakeup_tag;
+
+    void EventLoop::run()
+    {
+        size_t reactor_count = std::max<size_t>(1, options_.reactor_threads);
+        size_t worker_count = std::max<size_t>(1, options_.worker_threads);
+
+        // every reactor watches the listening socket (EPOLLEXCLUSIVE wakes only one) and the shutdown eventfd
+        std::vector<int> epfds;
+        for (size_t i = 0; i < reactor_count; ++i)
+        {
+            int epfd = epoll_create1(EPOLL_CLOEXEC);
+            if (epfd < 0)
+            {
+                LOG_ERROR("epoll_create1 failed: " << strerror(errno));
+                break;
+            }
+            epoll_event ev{};
+            ev.events = EPOLLIN | EPOLLEXCLUSIVE;
+            ev.data.ptr = &g_listen_tag;
+            epoll_ctl(epfd, EPOLL_CTL_ADD, server_socket, &ev);
+            ev.events = EPOLLIN;
+            ev.data.ptr = &g_wakeup_tag;
+            epoll_ctl(epfd, EPOLL_CTL_ADD, g_wakeup_fd, &ev);
+            epfds.push_back(epfd);
+        }
+
+        std::vector<std::thread> workers;
+        for (size_t i = 0; i < worker_count; ++i)
+            workers.emplace_back(&EventLoop::worker_loop, this);
+        std::vector<std::thread> reactors;
+        for (int epfd : epfds)
+            reactors.emplace_back(&EventLoop::reactor_loop, this, epfd);
+        LOG_INFO("Event loop started with " << epfds.size() << " reactor(s) and " << worker_count << " worker(s).");
+
+        for (auto &t : reactors)
+            t.join();
+
+        LOG_INFO("Start shutting down.");
+        {
+            std::lock_guard<std::mutex> guard(queue_mutex_);
+            stop_workers_ = true;
+        }
+        queue_cv_.notify_all();
+        for (auto &t : workers)
+            t.join();
+
+        // no thread is left that could still hold a reference
+        retired_.insert(retired_.end(), conns_.begin(), conns_.end());
+        conns_.clear();
+        for (Connection *conn : retired_)
+        {
+            ::close(conn->fd);
+            delete conn;
+        }
+        retired_.clear();
+        for (int epfd : epfds)
+            ::close(epfd);
+    }
+
+    void EventLoop::reactor_loop(int epfd)
+    {
+        epoll_event events[64];
+        while (!g_program_shutdown)
+        {
+            int n = epoll_wait(epfd, events, 64, -1);
+            if (n < 0)
+            {
+                if (errno == EINTR)
+                    continue;
+                LOG_ERROR("epoll_wait failed: " << strerror(errno));
+                break;
+            }
+            for (int i = 0; i < n && !g_program_shutdown; ++i)
+            {
+                void *tag = events[i].data.ptr;
+                if (tag == &g_listen_tag)
+                    accept_all(epfd);
+                else if (tag != &g_wakeup_tag)
+                    on_event(static_cast<Connection *>(tag), events[i].events);
+            }
+            free_retired(epfd);
+        }
+    }
+
+    void EventLoop::on_event(Connection *conn, uint32_t events)
+    {
+        // a worker may close and release the connection while the reactor is still reading from it, so the
+        // reactor holds its own reference for the event. Retired connections are not revived: epoll_wait may
+        // have returned the event just before the socket left the epoll set, and such a connection stays
+        // allocated only until this reactor's next free_retired()
+        int refs = conn->refs.load();
+        do
+        {
+            if (refs == 0)
+                return;
+        } while (!conn->refs.compare_exchange_weak(refs, refs + 1));
+        bool attached;
+        {
+            std::lock_guard<std::mutex> guard(conn->state_mutex);
+            attached = conn->attached;
+        }
+        if (attached)
+        {
+            if (!conn->closed)
+                on_doorbell(conn);
+        }
+        else
+        {
+            // errors and hang-ups go to both sides: whichever touches the socket finds out what happened
+            if (events & (EPOLLOUT | EPOLLERR | EPOLLHUP))
+                on_writable(conn);
+            if (events & ~EPOLLOUT)
+                on_readable(conn);
+        }
+        update_events(conn);
+        release(conn);
+    }
+
+    void EventLoop::on_writable(Connection *conn)
+    {
+        if (conn->closed)
+            return;
+        ReplyStream::Segment *part = nullptr;
+        ReplyStream::Result r = conn->stream.drain(conn->fd, part);
+        if (r == ReplyStream::kBroken)
+        {
+            close_connection(conn);
+        }
+        else if (r == ReplyStream::kResume)
+        {
+            // the MGET is still in flight and keeps its reference; it only goes back to a worker
+            std::vector<Task> tasks(1);
+            {
+                std::lock_guard<std::mutex> guard(conn->state_mutex);
+                auto it = conn->parked.find(part);
+                if (it == conn->parked.end())
+                    return;
+                tasks[0].conn = conn;
+                tasks[0].request = std::move(it->second);
+                conn->parked.erase(it);
+            }
+            enqueue(tasks);
+        }
+    }
+
+    void EventLoop::free_retired(int epfd)
+    {
+        std::vector<Connection *> done;
+        {
+            std::lock_guard<std::mutex> guard(conns_mutex_);
+            auto mine = std::partition(retired_.begin(), retired_.end(), [epfd](Connection *conn)
+                                       { return conn->epfd != epfd; });
+            done.assign(mine, retired_.end());
+            retired_.erase(mine, retired_.end());
+        }
+        for (Connection *conn : done)
+        {
+            ::close(conn->fd);
+            delete conn;
+        }
+    }
+
+    void EventLoop::accept_all(int epfd)
+    {
+        for (;;)
+        {
+            int fd = accept4(server_socket, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+            if (fd == -1)
+            {
+                if (errno == EINTR)
+                    continue;
+                if (errno != EAGAIN && errno != EWOULDBLOCK && !g_program_shutdown)
+                    LOG_ERROR("Accept failed, errno = " << strerror(errno));
+                return;
+            }
+            auto *conn = new Connection(fd, epfd, next_id_++, bp_);
+            {
+                std::lock_guard<std::mutex> guard(conns_mutex_);
+                conns_.insert(conn);
+            }
+            epoll_event ev{};
+            ev.events = EPOLLIN | EPOLLRDHUP | EPOLLONESHOT;
+            ev.data.ptr = conn;
+            if (epoll_ctl(epfd, EPOLL_CTL_ADD, fd, &ev) == -1)
+            {
+                LOG_ERROR("epoll_ctl failed: " << strerror(errno));
+                close_connection(conn);
+            }
+        }
+    }
+
+    void EventLoop::on_readable(Connection *conn)
+    {
+        if (conn->closed)
+            return;
+        {
+            // an error or hang-up event while the input is held: the request being served finds out itself
+            std::lock_guard<std::mutex> guard(conn->state_mutex);
+            if (conn->input_held || conn->paused || conn->eof)
+                return;
+        }
+        // the whole request is read here without blocking; a slow or stalled client holds only its own buffer
+        for (;;)
+        {
+            size_t len;
+            unsigned char *dst = conn->reader.next(len);
+            ssize_t r = ::read(conn->fd, dst, len);
+            if (r > 0)
+            {
+                RequestReader::Status status = conn->reader.consumed(r);
+                if (status == RequestReader::kInvalid)
+                {
+                    close_connection(conn);
+                    return;
+                }
+                if (status == RequestReader::kReady && !dispatch(conn))
+                    return;
+                continue;
+            }
+            if (r == -1 && errno == EINTR)
+                continue;
+            if (r == -1 && (errno == EAGAIN || errno == EWOULDBLOCK))
+                return;
+            if (r == -1)
+            {
+                LOG_ERROR("Package read error: " << strerror(errno));
+                close_connection(conn);
+                return;
+            }
+            // the peer closed its write side: requests already read still get their replies
+            std::lock_guard<std::mutex> guard(conn->state_mutex);
+            conn->eof = true;
+            return;
+        }
+    }
+
+    bool EventLoop::dispatch(Connection *conn)
+    {
+        Task task;
+        task.conn = conn;
+        task.request = conn->reader.take();
+        // a complete tagged request leaves the input with the reactor; any other keeps it until finish()
+        bool more = task.request.tagged && task.request.last;
+        conn->refs.fetch_add(1);
+        {
+            std::lock_guard<std::mutex> guard(conn->state_mutex);
+            ++conn->in_flight;
+            if (!more)
+            {
+                conn->input_held = true;
+            }
+            else if (conn->in_flight >= kMaxInFlight)
+            {
+                // back-pressure: the request that brings in_flight below the limit re-arms the socket
+                conn->paused = true;
+                more = false;
+            }
+        }
+        {
+            std::lock_guard<std::mutex> guard(queue_mutex_);
+            queue_.push_back(std::move(task));
+        }
+        queue_cv_.notify_one();
+        // a client that does not read its replies gets no more requests served until the reactor has sent them
+        return more && conn->stream.backlog() <= kMaxReplyBacklog;
+    }
+
+    void EventLoop::on_doorbell(Connection *conn)
+    {
+        char bells[64];
+        for (;;)
+        {
+            ssize_t r = ::read(conn->fd, bells, sizeof(bells));
+            if (r > 0 || (r == -1 && errno == EINTR))
+                continue;
+            if (r == -1 && (errno == EAGAIN || errno == EWOULDBLOCK))
+                break;
+            if (r == -1)
+                LOG_ERROR("Package read error: " << strerror(errno));
+            close_connection(conn);
+            return;
+        }
+
+        // the reactor is the only consumer of the submission ring while the socket is disarmed; its event
+        // reference (on_event) keeps the connection alive while workers fail and close it underneath
+        std::vector<Task> tasks;
+        bool corrupt = false;
+        for (;;)
+        {
+            ShmRequest ring_request;
+            int r;
+            while ((r = conn->channel->Pop(ring_request)) > 0)
+            {
+                Task task;
+                task.conn = conn;
+                task.from_ring = true;
+                task.ring_request = ring_request;
+                tasks.push_back(std::move(task));
+            }
+            if (r < 0)
+            {
+                LOG_ERROR("Corrupted submission ring on socket " << conn->fd);
+                corrupt = true;
+                break;
+            }
+            // a doorbell rung after this point re-triggers the socket once it is re-armed
+            if (conn->channel->PrepareSleep())
+                break;
+        }
+        conn->refs.fetch_add(static_cast<int>(tasks.size()));
+        enqueue(tasks);
+        if (corrupt)
+            close_connection(conn);
+    }
+
+    void EventLoop::enqueue(std::vector<Task> &tasks)
+    {
+        if (tasks.empty())
+            return;
+        {
+            std::lock_guard<std::mutex> guard(queue_mutex_);
+            queue_.insert(queue_.end(), std::make_move_iterator(tasks.begin()), std::make_move_iterator(tasks.end()));
+        }
+        if (tasks.size() > 1)
+            queue_cv_.notify_all();
+        else
+            queue_cv_.notify_one();
+    }
+
+    void EventLoop::worker_loop()
+    {
+        auto buffer = std::make_unique<unsigned char[]>(kMaxPageSize);
+        std::unique_lock<std::mutex> lock(queue_mutex_);
+        for (;;)
+        {
+            queue_cv_.wait(lock, [this]
+                           { return stop_workers_ || !queue_.empty(); });
+            if (stop_workers_)
+                return;
+            Task task = std::move(queue_.front());
+            queue_.pop_front();
+            lock.unlock();
+
+            Connection *conn = task.conn;
+            if (task.from_ring)
+            {
+                // the channel lives as long as the connection; entries still queued behind one that broke
+                // the connection are dropped instead of served into a region the client has given up
+                if (!conn->closed && !serve_ring_request(bp_, *conn->channel, task.ring_request, conn->fd, conn->id))
+                    close_connection(conn);
+                release(conn);
+                lock.lock();
+                continue;
+            }
+            RequestContext ctx;
+            ctx.fd = conn->fd;
+            ctx.t_idx = conn->id;
+            ctx.buffer = buffer.get();
+            ctx.channel = &conn->channel;
+            ctx.tagged = task.request.tagged;
+            ctx.request_id = task.request.request_id;
+            ctx.stream = &conn->stream;
+            if (task.request.header.msg_type == ATTACH)
+            {
+                // ATTACH is untagged, so nothing new is dispatched while it runs: the count can only drop
+                std::lock_guard<std::mutex> guard(conn->state_mutex);
+                ctx.others_in_flight = conn->in_flight - 1;
+            }
+            // a parked MGET of a connection closed meanwhile is dropped rather than read from disk for no one
+            bool ok = !(task.request.part && conn->closed) && handle_request(bp_, task.request, ctx);
+            while (ok && ctx.parked && !park(conn, task.request))
+                ok = handle_request(bp_, task.request, ctx);
+            if (ok && ctx.parked)
+            {
+                // still in flight: the connection holds the request until the reactor resumes it
+                lock.lock();
+                continue;
+            }
+            conn->reader.recycle(std::move(task.request.payload));
+            finish(conn, task, ok, ctx.replies_queued);
+            lock.lock();
+        }
+    }
+
+    bool EventLoop::park(Connection *conn, Request &req)
+    {
+        ReplyStream::Segment *part = req.part;
+        {
+            std::lock_guard<std::mutex> guard(conn->state_mutex);
+            if (conn->closed)
+                return false;
+            conn->parked.emplace(part, std::move(req));
+        }
+        if (conn->stream.park(part))
+        {
+            // its copied page waits in the stream: the reactor must be watching for the socket to take it
+            update_events(conn);
+            return true;
+        }
+        // the reactor sent everything ahead of it meanwhile; a close may have taken it over instead
+        std::lock_guard<std::mutex> guard(conn->state_mutex);
+        auto it = conn->parked.find(part);
+        if (it == conn->parked.end())
+            return true;
+        req = std::move(it->second);
+        conn->parked.erase(it);
+        return false;
+    }
+
+    void EventLoop::finish(Connection *conn, const Task &task, bool ok, bool replies_queued)
+    {
+        bool update = replies_queued;
+        {
+            std::lock_guard<std::mutex> guard(conn->state_mutex);
+            --conn->in_flight;
+            if (!task.request.tagged || !task.request.last)
+            {
+                // the input was held for this request
+                conn->input_held = false;
+                update = true;
+            }
+            else if (conn->paused && conn->in_flight < kMaxInFlight)
+            {
+                conn->paused = false;
+                update = true;
+            }
+            if (conn->eof)
+                update = true;
+            if (conn->channel && !conn->attached)
+            {
+                conn->attached = true;
+                update = true;
+            }
+        }
+        if (!ok || g_program_shutdown)
+            close_connection(conn);
+        else if (update)
+            update_events(conn);
+        release(conn);
+    }
+
+    void EventLoop::update_events(Connection *conn)
+    {
+        std::unique_lock<std::mutex> guard(conn->state_mutex);
+        if (conn->closed)
+            return;
+        uint32_t events = 0;
+        if (conn->attached)
+        {
+            events = EPOLLIN | EPOLLRDHUP;
+        }
+        else if (conn->eof)
+        {
+            if (conn->in_flight == 0 && !conn->stream.pending())
+            {
+                guard.unlock();
+                close_connection(conn);
+                return;
+            }
+        }
+        else if (!conn->input_held && !conn->paused && conn->stream.backlog() <= kMaxReplyBacklog)
+        {
+            events = EPOLLIN | EPOLLRDHUP;
+        }
+        if (conn->stream.wants_output())
+            events |= EPOLLOUT;
+        // nothing to wait for: the registration stays disarmed, since even an empty one would report hang-ups
+        if (events == 0)
+            return;
+        epoll_event ev{};
+        ev.events = events | EPOLLONESHOT;
+        ev.data.ptr = conn;
+        if (epoll_ctl(conn->epfd, EPOLL_CTL_MOD, conn->fd, &ev) == -1 && !conn->closed)
+        {
+            guard.unlock();
+            LOG_ERROR("epoll_ctl failed: " << strerror(errno));
+            close_connection(conn);
+        }
+    }
+
+    void EventLoop::close_connection(Connection *conn)
+    {
+        if (conn->closed.exchange(true))
+            return;
+        // the descriptor itself is closed with the last reference, so it cannot be reused meanwhile
+        epoll_ctl(conn->epfd, EPOLL_CTL_DEL, conn->fd, nullptr);
+        shutdown(conn->fd, SHUT_RDWR);
+        // parked MGETs are still in flight: the workers finish them without serving them
+        std::vector<Task> tasks;
+        {
+            std::lock_guard<std::mutex> guard(conn->state_mutex);
+            for (auto &[part, req] : conn->parked)
+            {
+                tasks.emplace_back();
+                tasks.back().conn = conn;
+                tasks.back().request = std::move(req);
+            }
+            conn->parked.clear();
+        }
+        enqueue(tasks);
+        release(conn);
+    }
+
+    void EventLoop::release(Connection *conn)
+    {
+        if (conn->refs.fetch_sub(1) != 1)
+            return;
+        std::lock_guard<std::mutex> guard(conns_mutex_);
+        // during shutdown run() frees the remaining connections after all threads have exited
+        if (g_program_shutdown)
+            return;
+        // epoll_wait may already have handed the reactor an event for it (see on_event), so the reactor
+        // frees it once that batch of events is done
+        conns_.erase(conn);
+        retired_.push_back(conn);
+    }
+
+    void Server::Impl::run_event_loop()
+    {
+        int flags = fcntl(server_socket, F_GETFL);
+        fcntl(server_socket, F_SETFL, flags | O_NONBLOCK);
+        EventLoop loop(m_bufferpool, m_options);
+        loop.run();
+    }
+
+    // ======================
+    // Server
+    // ======================
+
+    Server::Server(BufferPool *bp, const char *socket_file, const ServerOptions &options)
+    {
+        pimpl_ = new Impl(bp, socket_file, options);
+    }
+
+    Server::~Server()
+    {
+        delete pimpl_;
+    }
+
+    void Server::request_shutdown() noexcept
+    {
+        g_program_shutdown = true;
+        // unblock accept() in thread mode and epoll_wait() in event mode
+        if (server_socket >= 0)
+            shutdown(server_socket, SHUT_RDWR);
+        if (g_wakeup_fd >= 0)
+        {
+            uint64_t one = 1;
+            ssize_t r = ::write(g_wakeup_fd, &one, sizeof(one));
+            (void)r;
+        }
+    }
+
+    /* create socket and bind -- unchanged logic */
+    int Server::create_socket()
+    {
+        server_socket = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (server_socket < 0)
+        {
+            LOG_ERROR("Create server socket failed, errno = " << strerror(errno));
+            return -1;
+        }
+
+        memset(&pimpl_->m_server_addr, 0, sizeof(pimpl_->m_server_addr));
+        strncpy(pimpl_->m_server_addr.sun_path, pimpl_->m_socket_file, sizeof(pimpl_->m_server_addr.sun_path) - 1);
+        pimpl_->m_server_addr.sun_family = AF_UNIX;
+        unlink(pimpl_->m_socket_file);
+
+        if (bind(server_socket, (struct sockaddr *)&pimpl_->m_server_addr, sizeof(pimpl_->m_server_addr)) == -1)
+        {
+            LOG_ERROR("Bind server socket failed, errno = " << strerror(errno));
+            return -1;
+        }
+        g_wakeup_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+        LOG_INFO("Create socket success.");
+        return 0;
+    }
+
+    void Server::listen_forever()
+    {
+        if (listen(server_socket, 1000) == -1)
+        {
+            LOG_ERROR("Listen server socket failed, errno = " << strerror(errno));
+            return;
+        }
+
+        if (pimpl_->m_options.reactor_threads > 0 && g_wakeup_fd >= 0)
+            pimpl_->run_event_loop();
+        else
+            pimpl_->run_threads();
 
         // remove socket file
+        ::close(server_socket);
+        server_socket = -1;
         unlink(pimpl_->m_socket_file);
         LOG_INFO("Server closed.");
     }
@@ -0,0 +1,124 @@
+#include "gaussdb/shm_channel.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+#include <string>
+
+namespace gaussdb::server
+{
+
+    ShmChannel::ShmChannel(uint32_t entries, uint32_t slot_size) : slot_size_(slot_size)
+    {
+        if (entries == 0 || entries > kShmMaxEntries || slot_size == 0)
+        {
+            throw std::invalid_argument("Invalid shared memory channel: " + std::to_string(entries) + " slots of " +
+                                        std::to_string(slot_size) + " bytes");
+        }
+        entries_ = 1;
+        while (entries_ < entries)
+            entries_ <<= 1;
+
+        const size_t page = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+        auto page_align = [page](size_t v)
+        { return (v + page - 1) / page * page; };
+        size_t sq_offset = sizeof(ShmRegionHeader);
+        size_t cq_offset = sq_offset + entries_ * sizeof(ShmRequest);
+        size_t slots_offset = page_align(cq_offset + entries_ * sizeof(ShmCompletion));
+        size_ = slots_offset + page_align(static_cast<size_t>(entries_) * slot_size_);
+
+        fd_ = ::memfd_create("gaussdb-shm", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+        if (fd_ < 0)
+            throw std::runtime_error(std::string("memfd_create failed: ") + std::strerror(errno));
+        // 封住大小：客户端截断文件会让服务端访问映射时收到 SIGBUS
+        if (::ftruncate(fd_, static_cast<off_t>(size_)) != 0 ||
+            ::fcntl(fd_, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_SEAL) != 0)
+        {
+            int err = errno;
+            ::close(fd_);
+            throw std::runtime_error(std::string("Failed to size shared memory channel: ") + std::strerror(err));
+        }
+        void *addr = ::mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+        if (addr == MAP_FAILED)
+        {
+            int err = errno;
+            ::close(fd_);
+            throw std::runtime_error("Failed to map shared memory channel of " + std::to_string(size_) +
+                                     " bytes: " + std::strerror(err));
+        }
+
+        auto *base = static_cast<unsigned char *>(addr);
+        header_ = new (base) ShmRegionHeader();
+        header_->entries = entries_;
+        header_->slot_size = slot_size_;
+        header_->sq_offset = sq_offset;
+        header_->cq_offset = cq_offset;
+        header_->slots_offset = slots_offset;
+        header_->size = size_;
+        // 服务端起初就在等待：客户端第一次提交须写 socket 唤醒
+        header_->sq.waiting.store(1);
+        header_->magic = kShmMagic;
+        sq_ = reinterpret_cast<ShmRequest *>(base + sq_offset);
+        cq_ = reinterpret_cast<ShmCompletion *>(base + cq_offset);
+        slots_ = base + slots_offset;
+    }
+
+    ShmChannel::~ShmChannel()
+    {
+        ::munmap(header_, size_);
+        CloseFd();
+    }
+
+    void ShmChannel::CloseFd() noexcept
+    {
+        if (fd_ >= 0)
+        {
+            ::close(fd_);
+            fd_ = -1;
+        }
+    }
+
+    int ShmChannel::Pop(ShmRequest &req)
+    {
+        uint32_t tail = header_->sq.tail.load();
+        uint32_t ready = tail - sq_head_;
+        if (ready == 0)
+            return 0;
+        if (ready > entries_)
+            return -1;
+        // 先复制再推进 head：推进后客户端即可复用该项
+        req = sq_[sq_head_ & (entries_ - 1)];
+        header_->sq.head.store(++sq_head_);
+        return 1;
+    }
+
+    bool ShmChannel::PrepareSleep()
+    {
+        header_->sq.waiting.store(1);
+        if (header_->sq.tail.load() == sq_head_)
+            return true;
+        header_->sq.waiting.store(0);
+        return false;
+    }
+
+    bool ShmChannel::Post(const ShmCompletion &completion)
+    {
+        std::lock_guard<std::mutex> guard(cq_mutex_);
+        if (cq_tail_ - header_->cq.head.load() >= entries_)
+            return false;
+        cq_[cq_tail_ & (entries_ - 1)] = completion;
+        header_->cq.tail.store(++cq_tail_);
+        return true;
+    }
+
+    bool ShmChannel::TakeWaiter()
+    {
+        // 先读后交换：客户端没有等待时不写共享缓存行
+        return header_->cq.waiting.load() != 0 && header_->cq.waiting.exchange(0) != 0;
+    }
+
+} // namespace gaussdb::server
@@ -0,0 +1,54 @@
+#include "gaussdb/sync_io_backend.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <cstring>
+#include <unistd.h>
+
+namespace gaussdb::buffer
+{
+
+    void SyncIoBackend::Submit(IoRequest *reqs, size_t count)
+    {
+        for (size_t i = 0; i < count; ++i)
+            reqs[i].ok = Execute(reqs[i]);
+    }
+
+    bool SyncIoBackend::Execute(IoRequest &req)
+    {
+        auto &iov = req.iov;
+        off_t offset = req.offset;
+        size_t first = 0;
+        while (first < iov.size())
+        {
+            int count = static_cast<int>(std::min<size_t>(iov.size() - first, IOV_MAX));
+            ssize_t n = req.write ? ::pwritev(req.fd, iov.data() + first, count, offset)
+                                  : ::preadv(req.fd, iov.data() + first, count, offset);
+            if (n == -1)
+            {
+                if (errno == EINTR)
+                    continue;
+                return false;
+            }
+            if (n == 0 && !req.write)
+            {
+                // 读到文件末尾：剩余部分补零
+                for (; first < iov.size(); ++first)
+                    std::memset(iov[first].iov_base, 0, iov[first].iov_len);
+                break;
+            }
+            offset += n;
+            size_t left = static_cast<size_t>(n);
+            while (first < iov.size() && left >= iov[first].iov_len)
+                left -= iov[first++].iov_len;
+            if (left > 0)
+            {
+                iov[first].iov_base = static_cast<char *>(iov[first].iov_base) + left;
+                iov[first].iov_len -= left;
+            }
+        }
+        return true;
+    }
+
+} // namespace gaussdb::buffer
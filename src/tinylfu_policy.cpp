@@ -0,0 +1,122 @@
+#include "gaussdb/tinylfu_policy.h"
+
+#include <algorithm>
+
+namespace gaussdb::buffer
+{
+
+    TinyLFUPolicy::TinyLFUPolicy(size_t capacity)
+        : window_capacity_(std::max<size_t>(1, capacity / 100)),
+          protected_capacity_((capacity - std::min(capacity, window_capacity_)) * 8 / 10),
+          sketch_(capacity)
+    {
+    }
+
+    PageList &TinyLFUPolicy::ListOf(Page *page) noexcept
+    {
+        switch (page->list_hook().queue)
+        {
+        case kWindow:
+            return window_;
+        case kProtected:
+            return protected_;
+        default:
+            return probation_;
+        }
+    }
+
+    void TinyLFUPolicy::RecordAccess(Page *page)
+    {
+        sketch_.increment(page->id());
+        auto &hook = page->list_hook();
+        if (hook.queue != kProbation)
+        {
+            ListOf(page).move_to_front(page);
+            return;
+        }
+
+        // 试用段再次命中：提升到保护段，保护段溢出则把冷端降级回试用段
+        probation_.erase(page);
+        protected_.push_front(page);
+        hook.queue = kProtected;
+        if (protected_.size() > protected_capacity_)
+        {
+            Page *demoted = protected_.back();
+            protected_.erase(demoted);
+            probation_.push_front(demoted);
+            demoted->list_hook().queue = kProbation;
+        }
+    }
+
+    void TinyLFUPolicy::Insert(Page *page)
+    {
+        sketch_.increment(page->id());
+        window_.push_front(page);
+        page->list_hook().queue = kWindow;
+
+        // 尚有空闲帧时不会经过 PickVictim，窗口溢出的页直接进入试用段
+        if (window_.size() > window_capacity_)
+        {
+            Page *overflow = window_.back();
+            window_.erase(overflow);
+            probation_.push_front(overflow);
+            overflow->list_hook().queue = kProbation;
+        }
+    }
+
+    Page *TinyLFUPolicy::MainVictim() const noexcept
+    {
+        Page *victim = probation_.back_unpinned();
+        return victim ? victim : protected_.back_unpinned();
+    }
+
+    Page *TinyLFUPolicy::PickVictim(pageno /*incoming*/)
+    {
+        // 只做选择、不移动任何页：调用方可能不驱逐返回的页（例如跳过脏页），准入在 Remove 中完成。
+        // 新页即将进入窗口；窗口已满时，窗口冷端的候选页需要离开窗口
+        if (window_.size() >= window_capacity_)
+        {
+            Page *candidate = window_.back_unpinned();
+            if (candidate)
+            {
+                Page *victim = MainVictim();
+                if (!victim)
+                    return candidate;
+                if (sketch_.estimate(candidate->id()) <= sketch_.estimate(victim->id()))
+                    return candidate; // 准入失败：驱逐候选页本身
+                return victim;        // 准入成功：驱逐主区的页，候选页在其被移除时进入试用段
+            }
+        }
+
+        Page *victim = MainVictim();
+        return victim ? victim : window_.back_unpinned();
+    }
+
+    void TinyLFUPolicy::ColdPages(size_t max, std::vector<Page *> &out) const
+    {
+        // 驱逐对象来自准入失败的窗口尾部或试用段尾部，保护段最后
+        size_t start = out.size();
+        window_.collect_back(out, max / 2);
+        probation_.collect_back(out, max - (out.size() - start));
+        protected_.collect_back(out, max - (out.size() - start));
+    }
+
+    void TinyLFUPolicy::Remove(Page *page)
+    {
+        bool from_main = page->list_hook().queue != kWindow;
+        ListOf(page).erase(page);
+        page->list_hook().queue = 0;
+
+        // 窗口已满时驱逐主区的页，说明窗口候选页通过了准入（见 PickVictim）：此时才把它移入试用段
+        if (!from_main || window_.size() < window_capacity_)
+            return;
+        Page *candidate = window_.back_unpinned();
+        if (candidate && sketch_.estimate(candidate->id()) > sketch_.estimate(page->id()))
+        {
+            window_.erase(candidate);
+            probation_.push_front(candidate);
+            candidate->list_hook().queue = kProbation;
+        }
+    }
+
+} // namespace gaussdb::buffer
@@ -0,0 +1,69 @@
+#include "gaussdb/two_queue_policy.h"
+
+#include <algorithm>
+
+namespace gaussdb::buffer
+{
+
+    TwoQueuePolicy::TwoQueuePolicy(size_t capacity)
+        : kin_(std::max<size_t>(1, capacity / 4)),
+          a1out_(std::max<size_t>(1, capacity / 2))
+    {
+    }
+
+    void TwoQueuePolicy::RecordAccess(Page *page)
+    {
+        // A1in 中的命中视为相关访问，不提升；只有 Am 按 LRU 调整
+        if (page->list_hook().queue == kAm)
+            am_.move_to_front(page);
+    }
+
+    void TwoQueuePolicy::Insert(Page *page)
+    {
+        if (a1out_.erase(page->id()))
+        {
+            am_.push_front(page);
+            page->list_hook().queue = kAm;
+        }
+        else
+        {
+            a1in_.push_front(page);
+            page->list_hook().queue = kA1in;
+        }
+    }
+
+    Page *TwoQueuePolicy::PickVictim(pageno /*incoming*/)
+    {
+        Page *victim = nullptr;
+        if (a1in_.size() > kin_ || am_.empty())
+            victim = a1in_.back_unpinned();
+        if (!victim)
+            victim = am_.back_unpinned();
+        if (!victim)
+            victim = a1in_.back_unpinned();
+        return victim;
+    }
+
+    void TwoQueuePolicy::Remove(Page *page)
+    {
+        if (page->list_hook().queue == kA1in)
+        {
+            a1in_.erase(page);
+            a1out_.push_front(page->id());
+        }
+        else
+        {
+            am_.erase(page);
+        }
+        page->list_hook().queue = 0;
+    }
+
+    void TwoQueuePolicy::ColdPages(size_t max, std::vector<Page *> &out) const
+    {
+        // 驱逐优先来自 A1in 尾部
+        size_t start = out.size();
+        a1in_.collect_back(out, max);
+        am_.collect_back(out, max - (out.size() - start));
+    }
+
+} // namespace gaussdb::buffer